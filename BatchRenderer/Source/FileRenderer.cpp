@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    FileRenderer.cpp
+    Streams one audio file through its own SimpleEQAudioProcessor.
+
+  ==============================================================================
+*/
+
+#include "FileRenderer.h"
+
+#include "../../Source/PluginProcessor.h"
+
+#include <iostream>
+#include <map>
+
+bool FileRenderer::isSupportedFile(const juce::File &file) {
+	return file.hasFileExtension("wav;wave;flac");
+}
+
+std::vector<FileRenderer::Job> FileRenderer::findJobs(const juce::StringArray &paths, const juce::File &outputDirectory, juce::String &error) {
+	std::vector<Job> jobs;
+	
+	for (auto &path : paths) {
+		auto file = juce::File::getCurrentWorkingDirectory().getChildFile(path);
+		
+		if (file.isDirectory()) {
+			for (auto &entry : juce::RangedDirectoryIterator(file, true, "*", juce::File::findFiles))
+				if (isSupportedFile(entry.getFile()))
+					jobs.push_back({ entry.getFile(), outputDirectory.getChildFile(entry.getFile().getRelativePathFrom(file)) });
+		} else if (isSupportedFile(file)) {
+			jobs.push_back({ file, outputDirectory.getChildFile(file.getFileName()) });
+		} else {
+			std::cout << "skipping " << file.getFullPathName() << std::endl;
+		}
+	}
+	
+	// e.g. two files of the same name passed on their own, or found at the top of two folders
+	std::map<juce::String, juce::File> inputForOutput;
+	
+	for (auto &job : jobs) {
+		auto key = job.output.getFullPathName();
+		
+		if (! juce::File::areFileNamesCaseSensitive())
+			key = key.toLowerCase();
+		
+		auto [existing, inserted] = inputForOutput.emplace(key, job.input);
+		
+		if (! inserted) {
+			error = existing->second.getFullPathName() + " and " + job.input.getFullPathName() + " would both render to " + job.output.getFullPathName();
+			return {};
+		}
+	}
+	
+	return jobs;
+}
+
+FileRenderer::Result FileRenderer::render(const Job &job, const Options &options) {
+	Result result;
+	const auto &input = job.input;
+	const auto &output = job.output;
+	
+	// per job, the format manager isn't meant to be shared across threads
+	juce::AudioFormatManager formatManager;
+	formatManager.registerBasicFormats();
+	
+	std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+	
+	if (reader == nullptr) {
+		result.error = "can't read " + input.getFullPathName();
+		return result;
+	}
+	
+	auto *format = formatManager.findFormatForFileExtension(input.getFileExtension());
+	
+	if (output == input) {
+		result.error = "would overwrite " + input.getFullPathName();
+		return result;
+	}
+	
+	if (! output.getParentDirectory().createDirectory()) {
+		result.error = "can't create " + output.getParentDirectory().getFullPathName();
+		return result;
+	}
+	
+	output.deleteFile();
+	auto stream = std::make_unique<juce::FileOutputStream>(output);
+	
+	if (format == nullptr || stream->failedToOpen()) {
+		result.error = "can't write " + output.getFullPathName();
+		return result;
+	}
+	
+	const auto sampleRate = reader->sampleRate;
+	const auto numChannels = (int) reader->numChannels;
+	const auto bitsPerSample = juce::jmin((int) reader->bitsPerSample, format->getPossibleBitDepths().getLast());
+	
+	std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), sampleRate, (unsigned int) numChannels,
+																		   bitsPerSample, reader->metadataValues, 0));
+	
+	if (writer == nullptr) {
+		result.error = "can't write " + output.getFullPathName() + " as " + format->getFormatName();
+		return result;
+	}
+	
+	// the writer owns the stream now
+	stream.release();
+	
+	SimpleEQAudioProcessor processor;
+	processor.setNonRealtime(true);
+	processor.setProcessingPrecision(options.doublePrecision ? juce::AudioProcessor::doublePrecision : juce::AudioProcessor::singlePrecision);
+	
+	// before the sample rate is known, so changing modes doesn't prepare everything twice
+	if (options.state.getSize() > 0)
+		processor.setStateInformation(options.state.getData(), (int) options.state.getSize());
+	
+	processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, options.blockSize);
+	
+	processor.prepareToPlay(sampleRate, options.blockSize);
+	
+	// the first `latency` samples out are the plugin filling up, they're dropped
+	// and the end of the file is flushed out with as many samples of silence
+	const auto latency = (juce::int64) processor.getLatencySamples();
+	const auto length = reader->lengthInSamples;
+	
+	juce::AudioBuffer<float> buffer(numChannels, options.blockSize);
+	juce::AudioBuffer<double> doubleBuffer(options.doublePrecision ? numChannels : 0, options.blockSize);
+	juce::MidiBuffer midi;
+	
+	const auto start = juce::Time::getHighResolutionTicks();
+	
+	for (juce::int64 position = 0; position < length + latency; position += options.blockSize) {
+		const auto numSamples = (int) juce::jmin((juce::int64) options.blockSize, length + latency - position);
+		buffer.setSize(numChannels, numSamples, false, false, true);
+		
+		// reading past the end gives silence
+		reader->read(&buffer, 0, numSamples, position, true, true);
+		
+		if (options.doublePrecision) {
+			doubleBuffer.makeCopyOf(buffer, true);
+			processor.processBlock(doubleBuffer, midi);
+			buffer.makeCopyOf(doubleBuffer, true);
+		} else {
+			processor.processBlock(buffer, midi);
+		}
+		
+		const auto skip = (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, latency - position);
+		
+		if (skip < numSamples && ! writer->writeFromAudioSampleBuffer(buffer, skip, numSamples - skip)) {
+			result.error = "failed writing " + output.getFullPathName();
+			break;
+		}
+	}
+	
+	result.cpuLoad = processor.getCpuLoadMeter().describe();
+	
+	processor.releaseResources();
+	
+	result.renderSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+	result.audioSeconds = (double) length / sampleRate;
+	
+	return result;
+}
@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    FileRenderer.h
+    Streams one audio file through its own SimpleEQAudioProcessor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <vector>
+
+/* one file per job, one processor per file, so files render independently on any number of threads.
+ * the output keeps the input's format, rate, channel count and bit depth, and the plugin's latency
+ * is compensated so the output lines up with the input sample for sample. */
+struct FileRenderer {
+	struct Options {
+		juce::MemoryBlock state;
+		int blockSize = 1024;
+		bool doublePrecision = false;
+	};
+	
+	/** one input and the file its rendering goes to */
+	struct Job {
+		juce::File input, output;
+	};
+	
+	struct Result {
+		juce::String error;
+		double audioSeconds = 0, renderSeconds = 0;
+		
+		// the processor's CpuLoadMeter report, the load is relative to playing the file back in realtime
+		juce::String cpuLoad;
+		
+		bool wasSuccessful() const { return error.isEmpty(); }
+	};
+	
+	static Result render(const Job &, const Options &);
+	
+	static bool isSupportedFile(const juce::File &);
+	
+	/** a job for every supported file among paths, which are files or folders searched recursively.
+	 * a folder's files keep their path below it in outputDirectory, so files of the same name in different
+	 * subfolders don't collide. if two inputs would still write the same output file, error names them
+	 * and no jobs are returned, as the parallel jobs would overwrite each other. */
+	static std::vector<Job> findJobs(const juce::StringArray &paths, const juce::File &outputDirectory, juce::String &error);
+};
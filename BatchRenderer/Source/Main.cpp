@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Renders WAV and FLAC files through SimpleEQ without a host, spread over every core.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "FileRenderer.h"
+#include "RendererCheck.h"
+#include "../../Source/PluginProcessor.h"
+
+#include <iostream>
+
+namespace {
+	void printUsage() {
+		std::cout << "usage: SimpleEQBatchRenderer [options] <files or folders...>" << std::endl
+				  << "  --state <file>       plugin state, a saved getStateInformation blob or a .json file" << std::endl
+				  << "  --output <folder>    where the rendered files go, a folder's subfolders are kept (default: ./rendered)" << std::endl
+				  << "  --threads <n>        files rendered at once (default: one per core)" << std::endl
+				  << "  --block-size <n>     samples per processBlock (default: 1024)" << std::endl
+				  << "  --double             process in double precision" << std::endl
+				  << "  --cpu-load           print each file's processBlock load histogram" << std::endl
+				  << "  --check              run the renderer's own checks instead, the exit code says whether they passed" << std::endl;
+	}
+	
+	/* the json is an object of parameter ids (or state properties, like "LinearPhase") and their values,
+	 * e.g. { "Peak Freq": 1000, "Peak Gain": 3, "LowCut Slope": 2 }. anything left out keeps its default.
+	 * it's applied to a default state and turned into the same blob getStateInformation writes. */
+	juce::MemoryBlock stateFromJson(const juce::var &json, juce::String &error) {
+		SimpleEQAudioProcessor processor;
+		auto state = processor.apvts.copyState();
+		
+		if (auto *object = json.getDynamicObject()) {
+			for (auto &property : object->getProperties()) {
+				auto parameter = state.getChildWithProperty("id", property.name.toString());
+				
+				if (parameter.isValid())
+					parameter.setProperty("value", (double) property.value, nullptr);
+				else if (processor.apvts.getParameter(property.name.toString()) == nullptr)
+					state.setProperty(property.name, property.value, nullptr);
+			}
+		} else {
+			error = "the state json has to be an object";
+		}
+		
+		juce::MemoryBlock block;
+		juce::MemoryOutputStream stream(block, false);
+		state.writeToStream(stream);
+		
+		return block;
+	}
+	
+	juce::MemoryBlock loadState(const juce::File &file, juce::String &error) {
+		juce::MemoryBlock block;
+		
+		if (! file.loadFileAsData(block)) {
+			error = "can't read " + file.getFullPathName();
+			return {};
+		}
+		
+		if (file.hasFileExtension("json")) {
+			juce::var json;
+			auto result = juce::JSON::parse(block.toString(), json);
+			
+			if (result.failed()) {
+				error = file.getFileName() + ": " + result.getErrorMessage();
+				return {};
+			}
+			
+			return stateFromJson(json, error);
+		}
+		
+		return block;
+	}
+}
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+	
+	juce::ArgumentList arguments(argc, argv);
+	
+	if (arguments.size() == 0 || arguments.containsOption("--help|-h")) {
+		printUsage();
+		return arguments.size() == 0 ? 1 : 0;
+	}
+	
+	if (arguments.containsOption("--check"))
+		return runRendererCheck();
+	
+	FileRenderer::Options options;
+	auto outputPath = arguments.containsOption("--output") ? arguments.getValueForOption("--output") : juce::String("rendered");
+	const auto outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(outputPath);
+	
+	options.blockSize = juce::jmax(1, arguments.containsOption("--block-size") ? arguments.getValueForOption("--block-size").getIntValue() : 1024);
+	options.doublePrecision = arguments.removeOptionIfFound("--double");
+	const auto printCpuLoad = arguments.removeOptionIfFound("--cpu-load");
+	
+	const auto numThreads = juce::jmax(1, arguments.containsOption("--threads") ? arguments.getValueForOption("--threads").getIntValue()
+																				  : juce::SystemStats::getNumCpus());
+	
+	if (arguments.containsOption("--state")) {
+		juce::String error;
+		options.state = loadState(arguments.getFileForOption("--state"), error);
+		
+		if (error.isNotEmpty()) {
+			std::cout << error << std::endl;
+			return 1;
+		}
+	}
+	
+	for (auto option : { "--state", "--output", "--threads", "--block-size" })
+		arguments.removeValueForOption(option);
+	
+	juce::StringArray paths;
+	
+	for (auto &argument : arguments.arguments)
+		paths.add(argument.text);
+	
+	juce::String error;
+	auto jobs = FileRenderer::findJobs(paths, outputDirectory, error);
+	
+	if (error.isNotEmpty()) {
+		std::cout << error << std::endl;
+		return 1;
+	}
+	
+	if (jobs.empty()) {
+		std::cout << "nothing to render" << std::endl;
+		return 1;
+	}
+	
+	if (! outputDirectory.createDirectory()) {
+		std::cout << "can't create " << outputDirectory.getFullPathName() << std::endl;
+		return 1;
+	}
+	
+	juce::CriticalSection lock;
+	double totalAudioSeconds = 0, totalRenderSeconds = 0;
+	int numFailed = 0;
+	
+	const auto start = juce::Time::getHighResolutionTicks();
+	
+	{
+		// files are independent, so each one is a job of its own
+		juce::ThreadPool pool(numThreads);
+		
+		for (auto &job : jobs) {
+			pool.addJob([&, job] {
+				// the path below the output folder, as same-named files from different folders both render
+				const auto name = job.output.getRelativePathFrom(outputDirectory);
+				auto result = FileRenderer::render(job, options);
+				
+				const juce::ScopedLock sl(lock);
+				
+				if (result.wasSuccessful()) {
+					totalAudioSeconds += result.audioSeconds;
+					totalRenderSeconds += result.renderSeconds;
+					
+					std::cout << name << ": " << juce::String(result.audioSeconds / juce::jmax(result.renderSeconds, 1.0e-9), 1)
+							  << "x realtime" << std::endl;
+					
+					if (printCpuLoad)
+						std::cout << result.cpuLoad << std::endl;
+				} else {
+					++numFailed;
+					std::cout << name << ": " << result.error << std::endl;
+				}
+			});
+		}
+		
+		while (pool.getNumJobs() > 0)
+			juce::Thread::sleep(20);
+	}
+	
+	const auto wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+	
+	// per core is the audio rendered per second of a core's time, overall is per second of wall clock
+	std::cout << std::endl
+			  << (int) jobs.size() - numFailed << " of " << (int) jobs.size() << " files, " << juce::String(totalAudioSeconds, 1) << " s of audio in "
+			  << juce::String(wallSeconds, 2) << " s on " << numThreads << " threads" << std::endl
+			  << "realtime factor: " << juce::String(totalAudioSeconds / juce::jmax(wallSeconds, 1.0e-9), 1) << "x overall, "
+			  << juce::String(totalAudioSeconds / juce::jmax(totalRenderSeconds, 1.0e-9), 1) << "x per core" << std::endl;
+	
+	return numFailed > 0 ? 1 : 0;
+}
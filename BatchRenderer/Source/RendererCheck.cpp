@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    RendererCheck.cpp
+    Renders a small temporary tree of files and fails when outputs go missing or overwrite each other.
+
+  ==============================================================================
+*/
+
+#include "RendererCheck.h"
+
+#include "FileRenderer.h"
+
+#include <iostream>
+
+namespace {
+	constexpr double sampleRate = 48000.0;
+	
+	bool writeNoise(const juce::File &file, int numSamples) {
+		if (! file.getParentDirectory().createDirectory())
+			return false;
+		
+		juce::AudioBuffer<float> buffer(2, numSamples);
+		juce::Random random(numSamples);
+		
+		for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+			for (int i = 0; i < numSamples; ++i)
+				buffer.setSample(channel, i, random.nextFloat() * 0.5f - 0.25f);
+		
+		file.deleteFile();
+		auto stream = std::make_unique<juce::FileOutputStream>(file);
+		
+		if (stream->failedToOpen())
+			return false;
+		
+		juce::WavAudioFormat format;
+		std::unique_ptr<juce::AudioFormatWriter> writer(format.createWriterFor(stream.get(), sampleRate, 2, 24, {}, 0));
+		
+		if (writer == nullptr)
+			return false;
+		
+		stream.release();
+		return writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+	}
+	
+	juce::int64 getLength(const juce::File &file) {
+		juce::WavAudioFormat format;
+		std::unique_ptr<juce::AudioFormatReader> reader(format.createReaderFor(file.createInputStream().release(), true));
+		
+		return reader != nullptr ? reader->lengthInSamples : -1;
+	}
+	
+	/* two files of the same name in different subfolders, rendered in parallel. each one has to end up
+	 * below its own subfolder of the output, with its own length, instead of the two writing one file */
+	juce::String checkSameNamesInSubfolders(const juce::File &root) {
+		const auto input = root.getChildFile("input"), output = root.getChildFile("output");
+		const std::array<std::pair<const char *, int>, 2> files { { { "a/kick.wav", 1000 }, { "b/kick.wav", 3000 } } };
+		
+		for (auto &[path, numSamples] : files)
+			if (! writeNoise(input.getChildFile(path), numSamples))
+				return "can't write " + input.getChildFile(path).getFullPathName();
+		
+		juce::String error;
+		const auto jobs = FileRenderer::findJobs({ input.getFullPathName() }, output, error);
+		
+		if (error.isNotEmpty())
+			return error;
+		
+		if (jobs.size() != files.size())
+			return "found " + juce::String((int) jobs.size()) + " files instead of " + juce::String((int) files.size());
+		
+		// at once, as the renderer itself runs them
+		juce::CriticalSection lock;
+		juce::StringArray errors;
+		
+		{
+			juce::ThreadPool pool((int) jobs.size());
+			
+			for (auto &job : jobs) {
+				pool.addJob([&, job] {
+					auto result = FileRenderer::render(job, {});
+					
+					const juce::ScopedLock sl(lock);
+					
+					if (! result.wasSuccessful())
+						errors.add(job.input.getFullPathName() + ": " + result.error);
+				});
+			}
+			
+			while (pool.getNumJobs() > 0)
+				juce::Thread::sleep(10);
+		}
+		
+		if (! errors.isEmpty())
+			return errors.joinIntoString(", ");
+		
+		for (auto &[path, numSamples] : files) {
+			const auto rendered = output.getChildFile(path);
+			
+			if (! rendered.existsAsFile())
+				return rendered.getFullPathName() + " is missing";
+			
+			if (getLength(rendered) != numSamples)
+				return rendered.getFullPathName() + " has " + juce::String(getLength(rendered)) + " samples instead of " + juce::String(numSamples);
+		}
+		
+		return {};
+	}
+	
+	/* the same two files passed on their own have nothing to tell their outputs apart, so nothing may be rendered */
+	juce::String checkSameNamesAsArguments(const juce::File &root) {
+		const auto input = root.getChildFile("input");
+		
+		juce::String error;
+		const auto jobs = FileRenderer::findJobs({ input.getChildFile("a/kick.wav").getFullPathName(), input.getChildFile("b/kick.wav").getFullPathName() },
+												 root.getChildFile("flat"), error);
+		
+		if (error.isEmpty())
+			return "no error for two inputs rendering to the same file";
+		
+		if (! jobs.empty())
+			return "jobs returned along with the error";
+		
+		return {};
+	}
+}
+
+int runRendererCheck() {
+	const auto root = juce::File::getSpecialLocation(juce::File::tempDirectory).getNonexistentChildFile("SimpleEQRendererCheck", {}, false);
+	
+	auto failed = false;
+	
+	auto check = [&failed](const juce::String &name, const juce::String &error) {
+		std::cout << name << ": " << (error.isEmpty() ? "passed" : "FAILED, " + error) << std::endl;
+		failed = failed || error.isNotEmpty();
+	};
+	
+	// the second case reuses the first one's inputs
+	check("same names in subfolders", checkSameNamesInSubfolders(root));
+	check("same names as arguments", checkSameNamesAsArguments(root));
+	
+	root.deleteRecursively();
+	
+	return failed ? 1 : 0;
+}
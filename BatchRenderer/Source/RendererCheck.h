@@ -0,0 +1,13 @@
+/*
+  ==============================================================================
+
+    RendererCheck.h
+    Renders a small temporary tree of files and fails when outputs go missing or overwrite each other.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/** returns 0 when every case passed, 1 when one didn't */
+int runRendererCheck();
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    Benchmark.h
+    A minimal harness for timing the plugin's hot paths in isolation.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <limits>
+
+/* benchmarks register themselves on construction, the same way juce::UnitTest does,
+ * so each one is just a static instance in its own translation unit. */
+struct Benchmark {
+	explicit Benchmark(const juce::String &benchmarkName);
+	virtual ~Benchmark();
+	
+	virtual void run() = 0;
+	
+	const juce::String &getName() const { return name; }
+	
+	static juce::Array<Benchmark*> &getAllBenchmarks();
+	
+	/** every value reported so far, one object per case: benchmark, case, value and unit */
+	static juce::Array<juce::var> &getAllResults();
+	
+protected:
+	/** calls function(iteration) `iterations` times per round and returns the fastest round, in nanoseconds per call */
+	template<typename Function>
+	static double measureNanoseconds(int iterations, Function &&function) {
+		constexpr int numRounds = 5;
+		auto best = std::numeric_limits<double>::max();
+		
+		for (int round = 0; round < numRounds; ++round) {
+			auto start = juce::Time::getHighResolutionTicks();
+			
+			for (int i = 0; i < iterations; ++i)
+				function(i);
+			
+			auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+			best = juce::jmin(best, seconds * 1.0e9 / iterations);
+		}
+		
+		return best;
+	}
+	
+	/** keeps the optimiser from throwing away work whose result is never looked at */
+	static void consume(double value) { sink = sink + value; }
+	
+	/** prints a result and keeps it for the json output */
+	void report(const juce::String &caseName, double value, const juce::String &unit);
+	
+private:
+	juce::String name;
+	
+	inline static volatile double sink = 0;
+};
@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    ChainBenchmarks.cpp
+    The vectorised chain against one juce::dsp::ProcessorChain per channel.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+#include "../../Source/PluginProcessor.h"
+
+struct ChainBenchmark : Benchmark {
+	ChainBenchmark() : Benchmark("Filter Chain") { }
+	
+	void run() override {
+		constexpr double sampleRate = 48000.0;
+		constexpr int numChannels = 2;
+		
+		// every band in use at the steepest slope, the worst case
+		ChainSettings settings;
+		settings.lowCutFreq = 80.f;
+		settings.highCutFreq = 12000.f;
+		settings.peakFreq = 1000.f;
+		settings.peakGainInDecibels = 6.f;
+		settings.peakQuality = 1.f;
+		settings.lowCutSlope = Slope_48;
+		settings.highCutSlope = Slope_48;
+		
+		for (auto blockSize : { 32, 64, 128, 256, 512, 1024 }) {
+			juce::AudioBuffer<float> buffer(numChannels, blockSize);
+			fillWithNoise(buffer);
+			
+			const auto iterations = juce::jmax(200, 200000 / blockSize);
+			const auto samplesPerIteration = double(blockSize * numChannels);
+			
+			std::array<MonoChainType<float>, numChannels> monoChains;
+			prepareMonoChains(monoChains, settings, sampleRate, blockSize);
+			
+			auto monoChainNs = measureNanoseconds(iterations, [&](int) {
+				juce::dsp::AudioBlock<float> block(buffer);
+				
+				for (size_t channel = 0; channel < monoChains.size(); ++channel) {
+					auto channelBlock = block.getSingleChannelBlock(channel);
+					monoChains[channel].process(juce::dsp::ProcessContextReplacing<float>(channelBlock));
+				}
+				
+				consume(buffer.getSample(0, 0));
+			});
+			
+			ChainCoefficients chainCoefficients;
+			chainCoefficients.settings = settings;
+			designLowCutFilter(settings, sampleRate, chainCoefficients.lowCut);
+			designPeakFilter(settings, sampleRate, chainCoefficients.peak);
+			designHighCutFilter(settings, sampleRate, chainCoefficients.highCut);
+			
+			VectorisedChain<float> vectorisedChain;
+			vectorisedChain.prepare(blockSize);
+			installCoefficients(vectorisedChain, chainCoefficients);
+			
+			auto vectorisedNs = measureNanoseconds(iterations, [&](int) {
+				vectorisedChain.process(juce::dsp::AudioBlock<float>(buffer));
+				consume(buffer.getSample(0, 0));
+			});
+			
+			const auto blockName = juce::String(blockSize) + " samples";
+			report("Two MonoChains, " + blockName, monoChainNs / samplesPerIteration, "ns/sample");
+			report("VectorisedChain, " + blockName, vectorisedNs / samplesPerIteration, "ns/sample");
+		}
+		
+		runChannelCountBenchmarks<float>(settings, sampleRate);
+		runChannelCountBenchmarks<double>(settings, sampleRate);
+	}
+	
+private:
+	// mono, stereo, 5.1, 7.1.4 and third order ambisonics through the chain pool, in either precision
+	template<typename SampleType>
+	static void runChannelCountBenchmarks(const ChainSettings &settings, double sampleRate) {
+		constexpr int blockSize = 256;
+		
+		ChainCoefficients chainCoefficients;
+		chainCoefficients.settings = settings;
+		designLowCutFilter(settings, sampleRate, chainCoefficients.lowCut);
+		designPeakFilter(settings, sampleRate, chainCoefficients.peak);
+		designHighCutFilter(settings, sampleRate, chainCoefficients.highCut);
+		
+		for (auto numChannels : { 1, 2, 6, 12, 16 }) {
+			juce::AudioBuffer<SampleType> buffer(numChannels, blockSize);
+			fillWithNoise(buffer);
+			
+			ChannelChainPool<SampleType> pool;
+			pool.prepare(numChannels, blockSize);
+			installCoefficients(pool, chainCoefficients);
+			
+			auto ns = measureNanoseconds(1000, [&](int) {
+				pool.process(juce::dsp::AudioBlock<SampleType>(buffer));
+				consume(buffer.getSample(0, 0));
+			});
+			
+			const auto precision = std::is_same_v<SampleType, double> ? "double" : "float";
+			report(juce::String("ChannelChainPool, ") + precision + ", " + juce::String(numChannels) + " channels", ns / blockSize, "ns/frame");
+		}
+	}
+	
+	template<typename SampleType>
+	static void fillWithNoise(juce::AudioBuffer<SampleType> &buffer) {
+		juce::Random random(1234);
+		
+		for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+			for (int i = 0; i < buffer.getNumSamples(); ++i)
+				buffer.setSample(channel, i, SampleType(random.nextFloat() * 2.f - 1.f));
+	}
+	
+	using CutDesign = juce::ReferenceCountedArray<juce::dsp::IIR::Coefficients<float>>;
+	
+	template<int Index>
+	static void loadCutSection(CutFilterType<float> &cut, const CutDesign &design) {
+		cut.setBypassed<Index>(Index >= design.size());
+		
+		if (Index < design.size())
+			*cut.get<Index>().coefficients = *design[Index];
+	}
+	
+	static void loadCut(CutFilterType<float> &cut, const CutDesign &design) {
+		loadCutSection<0>(cut, design);
+		loadCutSection<1>(cut, design);
+		loadCutSection<2>(cut, design);
+		loadCutSection<3>(cut, design);
+	}
+	
+	// the same two chains the processor used to run, one per channel, with the juce::dsp designs it used
+	template<typename Chains>
+	static void prepareMonoChains(Chains &chains, const ChainSettings &settings, double sampleRate, int blockSize) {
+		juce::dsp::ProcessSpec spec;
+		spec.maximumBlockSize = (juce::uint32) blockSize;
+		spec.numChannels = 1;
+		spec.sampleRate = sampleRate;
+		
+		const auto peak = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, settings.peakFreq, settings.peakQuality,
+																			  juce::Decibels::decibelsToGain(settings.peakGainInDecibels));
+		const auto lowCut = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(settings.lowCutFreq, sampleRate, (settings.lowCutSlope + 1) * 2);
+		const auto highCut = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(settings.highCutFreq, sampleRate, (settings.highCutSlope + 1) * 2);
+		
+		for (auto &chain : chains) {
+			*chain.template get<ChainPositions::Peak>().coefficients = *peak;
+			loadCut(chain.template get<ChainPositions::LowCut>(), lowCut);
+			loadCut(chain.template get<ChainPositions::HighCut>(), highCut);
+			chain.prepare(spec);
+		}
+	}
+};
+
+static ChainBenchmark chainBenchmark;
@@ -0,0 +1,259 @@
+/*
+  ==============================================================================
+
+    ChainCheck.cpp
+    Runs the vectorised chain and juce::dsp::IIR::Filters side by side and fails when their outputs differ.
+
+  ==============================================================================
+*/
+
+#include "ChainCheck.h"
+
+#include "../../Source/PluginProcessor.h"
+
+#include <iostream>
+#include <limits>
+
+namespace {
+	constexpr double sampleRate = 48000.0;
+	
+	// the chain is prepared for less than the host sends, so its own splitting gets checked as well
+	constexpr int preparedBlockSize = 256, hostBlockSize = 600, numBlocks = 8;
+	
+	struct Case {
+		juce::String name;
+		ChainSettings settings;
+	};
+	
+	template<typename SampleType>
+	typename juce::dsp::IIR::Coefficients<SampleType>::Ptr makeReferenceCoefficients(const BiquadCoefficients &section) {
+		return new juce::dsp::IIR::Coefficients<SampleType>((SampleType) section.b0, (SampleType) section.b1, (SampleType) section.b2,
+															  SampleType(1), (SampleType) section.a1, (SampleType) section.a2);
+	}
+	
+	template<int Index, typename SampleType>
+	void loadReferenceSection(CutFilterType<SampleType> &cut, const CutCoefficients &coefficients) {
+		cut.template get<Index>().coefficients = makeReferenceCoefficients<SampleType>(coefficients.sections[(size_t) Index]);
+		cut.template setBypassed<Index>(Index >= coefficients.numSections);
+	}
+	
+	template<typename SampleType>
+	void loadReferenceCut(CutFilterType<SampleType> &cut, const CutCoefficients &coefficients) {
+		loadReferenceSection<0>(cut, coefficients);
+		loadReferenceSection<1>(cut, coefficients);
+		loadReferenceSection<2>(cut, coefficients);
+		loadReferenceSection<3>(cut, coefficients);
+	}
+	
+	/* the structure the processor used to run, given exactly the sections the vectorised chain gets,
+	 * so any difference comes from the processing and not from the designs */
+	template<typename SampleType>
+	void prepareReference(MonoChainType<SampleType> &chain, const ChainCoefficients &chainCoefficients) {
+		const auto &settings = chainCoefficients.settings;
+		
+		loadReferenceCut(chain.template get<ChainPositions::LowCut>(), chainCoefficients.lowCut);
+		chain.template get<ChainPositions::Peak>().coefficients = makeReferenceCoefficients<SampleType>(chainCoefficients.peak);
+		loadReferenceCut(chain.template get<ChainPositions::HighCut>(), chainCoefficients.highCut);
+		
+		chain.template setBypassed<ChainPositions::LowCut>(settings.lowCutBypassed);
+		chain.template setBypassed<ChainPositions::Peak>(settings.peakBypassed);
+		chain.template setBypassed<ChainPositions::HighCut>(settings.highCutBypassed);
+		
+		juce::dsp::ProcessSpec spec;
+		spec.maximumBlockSize = (juce::uint32) hostBlockSize;
+		spec.numChannels = 1;
+		spec.sampleRate = sampleRate;
+		
+		chain.prepare(spec);
+	}
+	
+	ChainCoefficients design(const ChainSettings &settings) {
+		ChainCoefficients chainCoefficients;
+		chainCoefficients.settings = settings;
+		
+		designLowCutFilter(settings, sampleRate, chainCoefficients.lowCut);
+		designPeakFilter(settings, sampleRate, chainCoefficients.peak);
+		designHighCutFilter(settings, sampleRate, chainCoefficients.highCut);
+		
+		return chainCoefficients;
+	}
+	
+	template<typename SampleType>
+	void fillWithNoise(juce::AudioBuffer<SampleType> &buffer, juce::Random &random) {
+		for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+			for (int i = 0; i < buffer.getNumSamples(); ++i)
+				buffer.setSample(channel, i, SampleType(random.nextFloat() * 2.f - 1.f));
+	}
+	
+	/* a full register of channels, each with its own noise, through both. returns the largest difference */
+	template<typename SampleType>
+	double getMaxError(const ChainSettings &settings) {
+		constexpr int numChannels = VectorisedChain<SampleType>::numLanes;
+		
+		const auto chainCoefficients = design(settings);
+		
+		VectorisedChain<SampleType> chain;
+		chain.prepare(preparedBlockSize);
+		installCoefficients(chain, chainCoefficients);
+		
+		std::array<MonoChainType<SampleType>, numChannels> references;
+		
+		for (auto &reference : references)
+			prepareReference(reference, chainCoefficients);
+		
+		juce::AudioBuffer<SampleType> output(numChannels, hostBlockSize), expected(numChannels, hostBlockSize);
+		juce::Random random(1234);
+		auto maxError = 0.0;
+		
+		for (int block = 0; block < numBlocks; ++block) {
+			fillWithNoise(output, random);
+			expected.makeCopyOf(output, true);
+			
+			chain.process(juce::dsp::AudioBlock<SampleType>(output));
+			
+			juce::dsp::AudioBlock<SampleType> expectedBlock(expected);
+			
+			for (size_t channel = 0; channel < references.size(); ++channel) {
+				auto channelBlock = expectedBlock.getSingleChannelBlock(channel);
+				references[channel].process(juce::dsp::ProcessContextReplacing<SampleType>(channelBlock));
+			}
+			
+			for (int channel = 0; channel < numChannels; ++channel)
+				for (int i = 0; i < hostBlockSize; ++i)
+					maxError = juce::jmax(maxError, (double) std::abs(output.getSample(channel, i) - expected.getSample(channel, i)));
+		}
+		
+		return maxError;
+	}
+	
+	/* a pool with one full group and one partly used one, and a channel unlinked in each.
+	 * the unlinked channels are given every band bypassed, so through a linked update they have to come out untouched,
+	 * while the linked ones match the reference. once linked again they follow the next update like the others.
+	 * returns the largest difference, or infinity when an unlinked channel was filtered */
+	template<typename SampleType>
+	double getUnlinkedChannelError(const ChainSettings &settings) {
+		const auto numChannels = VectorisedChain<SampleType>::numLanes + 2;
+		const std::array<int, 2> unlinkedChannels { 1, numChannels - 1 };
+		
+		auto initialSettings = settings;
+		initialSettings.peakGainInDecibels = -settings.peakGainInDecibels;
+		
+		ChannelChainPool<SampleType> pool;
+		pool.prepare(numChannels, preparedBlockSize);
+		installCoefficients(pool, design(initialSettings));
+		
+		for (auto channel : unlinkedChannels)
+			pool.setChannelCoefficients(channel, nullptr, nullptr, nullptr);
+		
+		const auto chainCoefficients = design(settings);
+		installCoefficients(pool, chainCoefficients);
+		
+		std::vector<MonoChainType<SampleType>> references((size_t) numChannels);
+		
+		for (auto &reference : references)
+			prepareReference(reference, chainCoefficients);
+		
+		juce::AudioBuffer<SampleType> output(numChannels, hostBlockSize), expected(numChannels, hostBlockSize);
+		juce::Random random(1234);
+		auto maxError = 0.0;
+		
+		for (int block = 0; block < numBlocks; ++block) {
+			// halfway through the unlinked channels are linked again. their lanes have only run pass-through sections,
+			// so their state is still clear and a fresh reference picks up from there
+			if (block == numBlocks / 2) {
+				for (auto channel : unlinkedChannels) {
+					pool.linkChannel(channel);
+					prepareReference(references[(size_t) channel], chainCoefficients);
+				}
+				
+				installCoefficients(pool, chainCoefficients);
+			}
+			
+			fillWithNoise(output, random);
+			expected.makeCopyOf(output, true);
+			
+			pool.process(juce::dsp::AudioBlock<SampleType>(output));
+			
+			juce::dsp::AudioBlock<SampleType> expectedBlock(expected);
+			
+			for (int channel = 0; channel < numChannels; ++channel) {
+				const auto unlinked = ! pool.isChannelLinked(channel);
+				
+				if (! unlinked) {
+					auto channelBlock = expectedBlock.getSingleChannelBlock((size_t) channel);
+					references[(size_t) channel].process(juce::dsp::ProcessContextReplacing<SampleType>(channelBlock));
+				}
+				
+				for (int i = 0; i < hostBlockSize; ++i) {
+					const auto error = (double) std::abs(output.getSample(channel, i) - expected.getSample(channel, i));
+					
+					if (unlinked && error != 0)
+						return std::numeric_limits<double>::infinity();
+					
+					maxError = juce::jmax(maxError, error);
+				}
+			}
+		}
+		
+		return maxError;
+	}
+	
+	std::vector<Case> getCases() {
+		ChainSettings settings;
+		settings.lowCutFreq = 80.f;
+		settings.highCutFreq = 12000.f;
+		settings.peakFreq = 1000.f;
+		settings.peakGainInDecibels = 6.f;
+		settings.peakQuality = 1.f;
+		
+		std::vector<Case> cases;
+		
+		// every slope gets its own kernel
+		for (auto slope : { Slope_12, Slope_24, Slope_36, Slope_48 }) {
+			settings.lowCutSlope = settings.highCutSlope = slope;
+			cases.push_back({ "both cuts at " + juce::String(12 * (slope + 1)) + " dB/oct", settings });
+		}
+		
+		// and the bypassed bands are left out of the chain altogether
+		auto lowCutBypassed = settings, peakBypassed = settings, highCutBypassed = settings, allBypassed = settings;
+		lowCutBypassed.lowCutBypassed = true;
+		peakBypassed.peakBypassed = true;
+		highCutBypassed.highCutBypassed = true;
+		allBypassed.lowCutBypassed = allBypassed.peakBypassed = allBypassed.highCutBypassed = true;
+		
+		cases.push_back({ "low cut bypassed", lowCutBypassed });
+		cases.push_back({ "peak bypassed", peakBypassed });
+		cases.push_back({ "high cut bypassed", highCutBypassed });
+		cases.push_back({ "everything bypassed", allBypassed });
+		
+		return cases;
+	}
+}
+
+int runChainCheck() {
+	// the two run the same transposed direct form II in the same order. they'd match exactly,
+	// but the compiler may fuse multiply-adds differently in the SIMD and the scalar code
+	constexpr double floatTolerance = 1.0e-4, doubleTolerance = 1.0e-10;
+	
+	auto failed = false;
+	
+	auto check = [&failed](const juce::String &name, double floatError, double doubleError) {
+		const auto passed = floatError <= floatTolerance && doubleError <= doubleTolerance;
+		
+		std::cout << name << ": max error " << floatError << " in float, " << doubleError << " in double"
+				  << (passed ? "" : ", FAILED") << std::endl;
+		
+		failed = failed || ! passed;
+	};
+	
+	const auto cases = getCases();
+	
+	for (auto &testCase : cases)
+		check(testCase.name, getMaxError<float>(testCase.settings), getMaxError<double>(testCase.settings));
+	
+	// the steepest slopes, through a pool with unlinked channels
+	const auto &settings = cases[3].settings;
+	check("unlinked channels through a linked update", getUnlinkedChannelError<float>(settings), getUnlinkedChannelError<double>(settings));
+	
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,13 @@
+/*
+  ==============================================================================
+
+    ChainCheck.h
+    Runs the vectorised chain and juce::dsp::IIR::Filters side by side and fails when their outputs differ.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/** returns 0 when the chain matched the reference in every case, 1 when it didn't */
+int runChainCheck();
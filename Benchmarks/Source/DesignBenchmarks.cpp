@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    DesignBenchmarks.cpp
+    The closed form designers against the juce::dsp::FilterDesign path they replace.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+#include "../../Source/PluginProcessor.h"
+
+namespace {
+	// the juce::dsp designs the processor used before the closed form ones, kept here as the baseline
+	auto makePeakFilter(const ChainSettings &chainSettings, double sampleRate) {
+		return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality,
+																   juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+	}
+	
+	auto makeLowCutFilter(const ChainSettings &chainSettings, double sampleRate) {
+		return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, (chainSettings.lowCutSlope + 1) * 2);
+	}
+	
+	auto makeHighCutFilter(const ChainSettings &chainSettings, double sampleRate) {
+		return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, (chainSettings.highCutSlope + 1) * 2);
+	}
+}
+
+struct CoefficientDesignBenchmark : Benchmark {
+	CoefficientDesignBenchmark() : Benchmark("Coefficient Design") { }
+	
+	void run() override {
+		constexpr double sampleRate = 48000.0;
+		constexpr int iterations = 20000;
+		
+		// sweep the whole quantised range so nothing can be cached between calls
+		auto frequencyFor = [](int iteration) { return 20.f + float(iteration % 19981); };
+		
+		ChainSettings settings;
+		settings.peakGainInDecibels = 6.f;
+		settings.peakQuality = 1.f;
+		
+		auto juceNs = measureNanoseconds(iterations, [&](int i) {
+			settings.peakFreq = frequencyFor(i);
+			consume(makePeakFilter(settings, sampleRate)->getRawCoefficients()[0]);
+		});
+		
+		BiquadCoefficients peak;
+		auto closedFormNs = measureNanoseconds(iterations, [&](int i) {
+			settings.peakFreq = frequencyFor(i);
+			designPeakFilter(settings, sampleRate, peak);
+			consume(peak.b0);
+		});
+		
+		reportComparison("Peak", juceNs, closedFormNs);
+		
+		for (int slope = Slope_12; slope <= Slope_48; ++slope) {
+			settings.lowCutSlope = static_cast<Slope>(slope);
+			settings.highCutSlope = static_cast<Slope>(slope);
+			
+			const auto slopeName = juce::String(12 + slope * 12) + " dB/Oct";
+			CutCoefficients cut;
+			
+			juceNs = measureNanoseconds(iterations, [&](int i) {
+				settings.lowCutFreq = frequencyFor(i);
+				consume(makeLowCutFilter(settings, sampleRate)[0]->getRawCoefficients()[0]);
+			});
+			
+			closedFormNs = measureNanoseconds(iterations, [&](int i) {
+				settings.lowCutFreq = frequencyFor(i);
+				designLowCutFilter(settings, sampleRate, cut);
+				consume(cut.sections[0].b0);
+			});
+			
+			reportComparison("LowCut " + slopeName, juceNs, closedFormNs);
+			
+			juceNs = measureNanoseconds(iterations, [&](int i) {
+				settings.highCutFreq = frequencyFor(i);
+				consume(makeHighCutFilter(settings, sampleRate)[0]->getRawCoefficients()[0]);
+			});
+			
+			closedFormNs = measureNanoseconds(iterations, [&](int i) {
+				settings.highCutFreq = frequencyFor(i);
+				designHighCutFilter(settings, sampleRate, cut);
+				consume(cut.sections[0].b0);
+			});
+			
+			reportComparison("HighCut " + slopeName, juceNs, closedFormNs);
+		}
+		
+		runTableBenchmarks(iterations, frequencyFor);
+	}
+	
+private:
+	template<typename FrequencyFunction>
+	void runTableBenchmarks(int iterations, FrequencyFunction &&frequencyFor) {
+		for (auto sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0 }) {
+			CutCoefficientTable table(sampleRate);
+			
+			const auto rateName = juce::String(sampleRate / 1000.0) + " kHz";
+			report("Table build at " + rateName, table.getBuildTimeInMilliseconds(), "ms");
+			report("Table memory at " + rateName, table.getMemoryUsageInBytes() / (1024.0 * 1024.0), "MiB");
+			
+			CutCoefficients cut;
+			auto lookupNs = measureNanoseconds(iterations, [&](int i) {
+				table.lookupHighPass(cut, frequencyFor(i), CutCoefficients::maxNumSections);
+				consume(cut.sections[0].b0);
+			});
+			
+			report("Table lookup 48 dB/Oct at " + rateName, lookupNs, "ns/design");
+		}
+	}
+	
+	void reportComparison(const juce::String &band, double juceNs, double closedFormNs) {
+		report(band + " juce::dsp::FilterDesign", juceNs, "ns/design");
+		report(band + " closed form", closedFormNs, "ns/design");
+		report(band + " closed form share of juce", 100.0 * closedFormNs / juceNs, "%");
+	}
+};
+
+static CoefficientDesignBenchmark coefficientDesignBenchmark;
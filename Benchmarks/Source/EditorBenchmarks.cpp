@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    EditorBenchmarks.cpp
+    The analyzer's FFTs and path generation and the response curve's paint, each in isolation.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+#include "../../Source/PluginEditor.h"
+
+struct EditorBenchmark : Benchmark {
+	EditorBenchmark() : Benchmark("Editor") { }
+	
+	void run() override {
+		constexpr double sampleRate = 48000.0;
+		constexpr float negativeInfinity = -48.f;
+		
+		FFTDataGenerator<std::vector<float>> fftDataGenerator;
+		juce::Random random(1234);
+		
+		for (auto order : { FFTOrder::order2048, FFTOrder::order4096, FFTOrder::order8192 }) {
+			fftDataGenerator.changeOrder(order);
+			
+			const auto fftSize = fftDataGenerator.getFFTSize();
+			const auto numBins = fftSize / 2;
+			const auto points = juce::String(fftSize) + " points";
+			
+			juce::AudioBuffer<float> audio(2, fftSize);
+			
+			for (int channel = 0; channel < 2; ++channel)
+				for (int i = 0; i < fftSize; ++i)
+					audio.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+			
+			// read straight back out in place, so the fifo never fills up and skips the frame
+			auto fftNs = measureNanoseconds(2000, [&](int) {
+				fftDataGenerator.produceFFTDataForRendering(audio, negativeInfinity);
+				fftDataGenerator.readFFTData([&](const std::vector<float> &frame) { consume(frame[1]); });
+			});
+			
+			report("produceFFTDataForRendering, " + points, fftNs / 1000.0, "us");
+			
+			// both channels as two real transforms against one packed complex transform
+			auto monoPairNs = measureNanoseconds(2000, [&](int) {
+				for (int channel = 0; channel < 2; ++channel) {
+					fftDataGenerator.produceFFTDataForRendering(audio.getReadPointer(channel), fftSize, nullptr, 0, negativeInfinity);
+					fftDataGenerator.readFFTData([&](const std::vector<float> &frame) { consume(frame[1]); });
+				}
+			});
+			
+			report("two channels as two transforms, " + points, monoPairNs / 1000.0, "us");
+			
+			auto stereoNs = measureNanoseconds(2000, [&](int) {
+				fftDataGenerator.produceStereoFFTDataForRendering(audio.getReadPointer(0), audio.getReadPointer(1), 0, negativeInfinity);
+				fftDataGenerator.readFFTData([&](const std::vector<float> &frame) { consume(frame[1]); });
+			});
+			
+			report("produceStereoFFTDataForRendering, " + points, stereoNs / 1000.0, "us");
+			
+			// the dB pass on its own against the per bin gainToDecibels it replaced, on magnitudes from -120 to +20 dB
+			std::vector<float> magnitudes((size_t) numBins), decibels((size_t) numBins);
+			
+			for (auto &magnitude : magnitudes)
+				magnitude = juce::Decibels::decibelsToGain(random.nextFloat() * 140.f - 120.f) * float(numBins);
+			
+			auto referenceNs = measureNanoseconds(2000, [&](int) {
+				for (int i = 0; i < numBins; ++i)
+					decibels[(size_t) i] = juce::Decibels::gainToDecibels(magnitudes[(size_t) i] / float(numBins), -200.f);
+				
+				consume(decibels[1]);
+			});
+			
+			report("gainToDecibels per bin, " + points, referenceNs / 1000.0, "us");
+			
+			std::vector<float> reference(decibels);
+			
+			auto fusedNs = measureNanoseconds(2000, [&](int) {
+				std::copy(magnitudes.begin(), magnitudes.end(), decibels.begin());
+				FFTDataGenerator<std::vector<float>>::magnitudesToDecibels(decibels.data(), numBins, float(numBins), -200.f);
+				consume(decibels[1]);
+			});
+			
+			report("magnitudesToDecibels, " + points, fusedNs / 1000.0, "us");
+			
+			auto maxError = 0.f;
+			
+			for (size_t i = 0; i < reference.size(); ++i)
+				maxError = juce::jmax(maxError, std::abs(decibels[i] - reference[i]));
+			
+			report("magnitudesToDecibels max error, " + points, maxError, "dB");
+		}
+		
+		// the path generation runs on a 2048 point frame
+		fftDataGenerator.changeOrder(FFTOrder::order2048);
+		
+		const auto fftSize = fftDataGenerator.getFFTSize();
+		
+		juce::AudioBuffer<float> audio(1, fftSize);
+		
+		for (int i = 0; i < fftSize; ++i)
+			audio.setSample(0, i, random.nextFloat() * 2.f - 1.f);
+		
+		std::vector<float> fftData;
+		
+		fftDataGenerator.produceFFTDataForRendering(audio, negativeInfinity);
+		fftDataGenerator.getFFTData(fftData);
+		
+		AnalyzerPathGenerator<juce::Path> pathGenerator;
+		juce::Path path;
+		const auto bounds = juce::Rectangle<float>(0, 0, 560, 160);
+		
+		auto pathNs = measureNanoseconds(2000, [&](int) {
+			pathGenerator.generatePath(fftData, bounds, fftSize, float(sampleRate / fftSize), negativeInfinity);
+			pathGenerator.getPath(path);
+			consume(path.getBounds().getWidth());
+		});
+		
+		report("generatePath, 2048 points", pathNs / 1000.0, "us");
+		
+		SimpleEQAudioProcessor processor;
+		processor.setRateAndBufferSizeDetails(sampleRate, 512);
+		processor.prepareToPlay(sampleRate, 512);
+		
+		ResponseCurveComponent responseCurve(processor);
+		responseCurve.setSize(600, 240);
+		
+		juce::Image image(juce::Image::ARGB, responseCurve.getWidth(), responseCurve.getHeight(), true);
+		
+		// the first paint builds the response curve, every one after only draws it
+		{
+			auto start = juce::Time::getHighResolutionTicks();
+			juce::Graphics g(image);
+			responseCurve.paint(g);
+			auto firstPaintSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+			
+			report("ResponseCurveComponent::paint, 600x240, building the curve", firstPaintSeconds * 1.0e6, "us");
+		}
+		
+		auto paintNs = measureNanoseconds(200, [&](int) {
+			juce::Graphics g(image);
+			responseCurve.paint(g);
+		});
+		
+		report("ResponseCurveComponent::paint, 600x240, cached curve", paintNs / 1000.0, "us");
+	}
+};
+
+static EditorBenchmark editorBenchmark;
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    LinearPhaseBenchmarks.cpp
+    Building and running the linear phase kernel at every length.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+#include "../../Source/PluginProcessor.h"
+
+struct LinearPhaseBenchmark : Benchmark {
+	LinearPhaseBenchmark() : Benchmark("Linear Phase") { }
+	
+	void run() override {
+		constexpr double sampleRate = 48000.0;
+		constexpr int blockSize = 512;
+		constexpr int numChannels = 2;
+		
+		ChainSettings settings;
+		settings.lowCutFreq = 80.f;
+		settings.highCutFreq = 12000.f;
+		settings.peakFreq = 1000.f;
+		settings.peakGainInDecibels = 6.f;
+		settings.peakQuality = 1.f;
+		settings.lowCutSlope = Slope_48;
+		settings.highCutSlope = Slope_48;
+		
+		ChainCoefficients chainCoefficients;
+		chainCoefficients.settings = settings;
+		designLowCutFilter(settings, sampleRate, chainCoefficients.lowCut);
+		designPeakFilter(settings, sampleRate, chainCoefficients.peak);
+		designHighCutFilter(settings, sampleRate, chainCoefficients.highCut);
+		
+		auto getMagnitude = [&](double frequency) { return getMagnitudeForFrequency(chainCoefficients, frequency, sampleRate); };
+		
+		for (int kernelLength = LinearPhaseFilter::minKernelLength; kernelLength <= LinearPhaseFilter::maxKernelLength; kernelLength *= 2) {
+			juce::AudioBuffer<float> buffer(numChannels, blockSize);
+			juce::Random random(1234);
+			
+			for (int channel = 0; channel < numChannels; ++channel)
+				for (int i = 0; i < blockSize; ++i)
+					buffer.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+			
+			LinearPhaseFilter filter;
+			filter.prepare(numChannels, blockSize, sampleRate, kernelLength);
+			
+			auto buildNs = measureNanoseconds(10, [&](int) { filter.loadKernel(getMagnitude); });
+			
+			// the kernel is swapped in on a background thread and crossfaded, let that finish before timing
+			for (int i = 0; i < 20; ++i) {
+				juce::Thread::sleep(10);
+				filter.process(juce::dsp::AudioBlock<float>(buffer));
+			}
+			
+			auto processNs = measureNanoseconds(500, [&](int) {
+				filter.process(juce::dsp::AudioBlock<float>(buffer));
+				consume(buffer.getSample(0, 0));
+			});
+			
+			const auto caseName = juce::String(kernelLength) + " taps";
+			report(caseName + ", kernel build", buildNs / 1.0e6, "ms");
+			report(caseName + ", processing", processNs / blockSize, "ns/frame");
+			report(caseName + ", latency", filter.getLatencyInSamples(), "samples");
+		}
+	}
+};
+
+static LinearPhaseBenchmark linearPhaseBenchmark;
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Runs every registered benchmark, or only those whose name contains the first argument.
+    --json <file> also writes the results there, to compare between versions.
+    --check-realtime runs the realtime safety check instead, its exit code says whether it passed.
+    --check-chain runs the chain against juce's IIR filters instead, the same way.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "Benchmark.h"
+#include "RealtimeSafetyCheck.h"
+#include "ChainCheck.h"
+
+#include <iostream>
+
+Benchmark::Benchmark(const juce::String &benchmarkName) : name(benchmarkName) {
+	getAllBenchmarks().add(this);
+}
+
+Benchmark::~Benchmark() {
+	getAllBenchmarks().removeFirstMatchingValue(this);
+}
+
+juce::Array<Benchmark*> &Benchmark::getAllBenchmarks() {
+	static juce::Array<Benchmark*> benchmarks;
+	return benchmarks;
+}
+
+juce::Array<juce::var> &Benchmark::getAllResults() {
+	static juce::Array<juce::var> results;
+	return results;
+}
+
+void Benchmark::report(const juce::String &caseName, double value, const juce::String &unit) {
+	std::cout << "  " << caseName << ": " << juce::String(value, 2) << " " << unit << std::endl;
+	
+	auto *result = new juce::DynamicObject();
+	result->setProperty("benchmark", name);
+	result->setProperty("case", caseName);
+	result->setProperty("value", value);
+	result->setProperty("unit", unit);
+	
+	getAllResults().add(juce::var(result));
+}
+
+namespace {
+	// enough about the run to tell two result files apart
+	void writeJson(const juce::File &file) {
+		auto *root = new juce::DynamicObject();
+		root->setProperty("version", ProjectInfo::versionString);
+		root->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+		root->setProperty("os", juce::SystemStats::getOperatingSystemName());
+		root->setProperty("cpu", juce::SystemStats::getCpuModel());
+		root->setProperty("numCpus", juce::SystemStats::getNumCpus());
+		root->setProperty("results", Benchmark::getAllResults());
+		
+		if (! file.replaceWithText(juce::JSON::toString(juce::var(root))))
+			std::cout << "can't write " << file.getFullPathName() << std::endl;
+	}
+}
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+	
+	juce::ArgumentList arguments(argc, argv);
+	
+	if (arguments.containsOption("--check-realtime"))
+		return runRealtimeSafetyCheck();
+	
+	if (arguments.containsOption("--check-chain"))
+		return runChainCheck();
+	
+	juce::File jsonFile;
+	
+	if (arguments.containsOption("--json")) {
+		jsonFile = arguments.getFileForOption("--json");
+		arguments.removeValueForOption("--json");
+	}
+	
+	const auto filter = arguments.size() > 0 ? arguments[0].text : juce::String();
+	
+	for (auto *benchmark : Benchmark::getAllBenchmarks()) {
+		if (filter.isNotEmpty() && ! benchmark->getName().containsIgnoreCase(filter))
+			continue;
+		
+		std::cout << benchmark->getName() << std::endl;
+		benchmark->run();
+	}
+	
+	if (jsonFile != juce::File())
+		writeJson(jsonFile);
+	
+	return 0;
+}
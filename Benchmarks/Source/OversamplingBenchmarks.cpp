@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    OversamplingBenchmarks.cpp
+    The whole processBlock at every oversampling factor, to pick one per session.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+#include "../../Source/PluginProcessor.h"
+
+struct OversamplingBenchmark : Benchmark {
+	OversamplingBenchmark() : Benchmark("Oversampling") { }
+	
+	void run() override {
+		constexpr int blockSize = 512;
+		
+		for (auto sampleRate : { 44100.0, 48000.0, 96000.0 }) {
+			for (int order = 0; order <= SimpleEQAudioProcessor::maxOversamplingOrder; ++order) {
+				SimpleEQAudioProcessor processor;
+				processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+				processor.setOversamplingOrder(order);
+				processor.prepareToPlay(sampleRate, blockSize);
+				
+				juce::AudioBuffer<float> buffer(processor.getTotalNumOutputChannels(), blockSize);
+				juce::MidiBuffer midi;
+				juce::Random random(1234);
+				
+				auto ns = measureNanoseconds(500, [&](int) {
+					for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+						buffer.setSample(channel, 0, random.nextFloat() * 2.f - 1.f);
+					
+					processor.processBlock(buffer, midi);
+					consume(buffer.getSample(0, 0));
+				});
+				
+				const auto caseName = juce::String(1 << order) + "x at " + juce::String(sampleRate / 1000.0, 1) + " kHz";
+				report(caseName, ns / blockSize, "ns/frame");
+				report(caseName + ", latency", processor.getLatencySamples(), "samples");
+			}
+		}
+	}
+};
+
+static OversamplingBenchmark oversamplingBenchmark;
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    ProcessorBenchmarks.cpp
+    The whole processBlock across block sizes, sample rates, slopes and bypasses, and the coefficient design.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+#include "../../Source/PluginProcessor.h"
+
+struct ProcessorBenchmark : Benchmark {
+	ProcessorBenchmark() : Benchmark("Processor") { }
+	
+	void run() override {
+		// every band in use at a moderate slope, then one dimension varied at a time
+		for (auto sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0 })
+			for (auto blockSize : { 32, 64, 128, 256, 512, 1024, 2048 })
+				runProcessBlock(sampleRate, blockSize, Slope_24, 0, juce::String(sampleRate / 1000.0, 1) + " kHz, " + juce::String(blockSize) + " samples");
+		
+		for (auto slope : { Slope_12, Slope_24, Slope_36, Slope_48 })
+			runProcessBlock(48000.0, 512, slope, 0, juce::String(12 * (slope + 1)) + " dB/Oct");
+		
+		// one bit per band, set when the band is bypassed
+		for (int bypasses = 0; bypasses < 8; ++bypasses) {
+			juce::String bypassed;
+			
+			if (bypasses & 1) bypassed << " low cut";
+			if (bypasses & 2) bypassed << " peak";
+			if (bypasses & 4) bypassed << " high cut";
+			
+			runProcessBlock(48000.0, 512, Slope_24, bypasses, "bypassed:" + (bypassed.isEmpty() ? juce::String(" none") : bypassed));
+		}
+		
+		runUpdateFilters();
+	}
+	
+private:
+	static void setParameter(SimpleEQAudioProcessor &processor, const juce::String &id, float value) {
+		auto *parameter = processor.apvts.getParameter(id);
+		parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+	}
+	
+	static void setUp(SimpleEQAudioProcessor &processor, double sampleRate, int blockSize, Slope slope, int bypasses) {
+		setParameter(processor, "LowCut Freq", 80.f);
+		setParameter(processor, "HighCut Freq", 12000.f);
+		setParameter(processor, "Peak Freq", 1000.f);
+		setParameter(processor, "Peak Gain", 6.f);
+		setParameter(processor, "LowCut Slope", (float) slope);
+		setParameter(processor, "HighCut Slope", (float) slope);
+		setParameter(processor, "LowCut Bypassed", (bypasses & 1) ? 1.f : 0.f);
+		setParameter(processor, "Peak Bypassed", (bypasses & 2) ? 1.f : 0.f);
+		setParameter(processor, "HighCut Bypassed", (bypasses & 4) ? 1.f : 0.f);
+		
+		processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+		processor.prepareToPlay(sampleRate, blockSize);
+	}
+	
+	void runProcessBlock(double sampleRate, int blockSize, Slope slope, int bypasses, const juce::String &caseName) {
+		SimpleEQAudioProcessor processor;
+		setUp(processor, sampleRate, blockSize, slope, bypasses);
+		
+		juce::AudioBuffer<float> buffer(processor.getTotalNumOutputChannels(), blockSize);
+		juce::MidiBuffer midi;
+		juce::Random random(1234);
+		
+		for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+			for (int i = 0; i < blockSize; ++i)
+				buffer.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+		
+		// about 200k samples per round whatever the block size
+		auto ns = measureNanoseconds(juce::jmax(20, 200000 / blockSize), [&](int) {
+			processor.processBlock(buffer, midi);
+			consume(buffer.getSample(0, 0));
+		});
+		
+		report("processBlock, " + caseName, ns / double(blockSize * buffer.getNumChannels()), "ns/sample");
+	}
+	
+	// a full redesign of every band, what updateFilters() does after prepareToPlay or a state change
+	void runUpdateFilters() {
+		for (auto tables : { false, true }) {
+			SimpleEQAudioProcessor processor;
+			processor.setCoefficientRampSubBlockSize(0);
+			processor.setUsesCoefficientTables(tables);
+			setUp(processor, 48000.0, 512, Slope_48, 0);
+			
+			auto ns = measureNanoseconds(10000, [&](int) {
+				processor.chainParameters.invalidateAll();
+				processor.designIfNeeded();
+			});
+			
+			report(juce::String("updateFilters, ") + (tables ? "coefficient tables" : "closed form"), ns, "ns");
+		}
+	}
+};
+
+static ProcessorBenchmark processorBenchmark;
@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    RampBenchmarks.cpp
+    What the sub-block size of the coefficient ramp costs, and how far it is from ramping every sample.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+#include "../../Source/PluginProcessor.h"
+
+struct CoefficientRampBenchmark : Benchmark {
+	CoefficientRampBenchmark() : Benchmark("Coefficient Ramp") { }
+	
+	void run() override {
+		// the reference ramps every sample, a sub-block the size of the block is the old once per block update
+		const auto reference = render(1);
+		
+		for (auto subBlockSize : { blockSize, 128, 64, 32, 16, 8 }) {
+			juce::AudioBuffer<float> output;
+			
+			auto ns = measureNanoseconds(5, [&](int) {
+				output = render(subBlockSize);
+				consume(output.getSample(0, 0));
+			});
+			
+			const auto caseName = subBlockSize == blockSize ? juce::String("once per block")
+															: juce::String(subBlockSize) + " sample sub-blocks";
+			
+			report(caseName, ns / double(numBlocks * blockSize * numChannels), "ns/sample");
+			report(caseName + ", error against every sample", getErrorInDecibels(output, reference), "dB");
+		}
+	}
+	
+private:
+	static constexpr double sampleRate = 48000.0;
+	static constexpr int blockSize = 512;
+	static constexpr int numBlocks = 200;
+	static constexpr int numChannels = 2;
+	
+	// sweeps a +12 dB peak from 200 Hz to 8 kHz over the whole render, new settings every block
+	static juce::AudioBuffer<float> render(int subBlockSize) {
+		juce::AudioBuffer<float> buffer(numChannels, numBlocks * blockSize);
+		fillWithNoise(buffer);
+		
+		ChainSettings settings;
+		settings.lowCutFreq = 20.f;
+		settings.highCutFreq = 20000.f;
+		settings.lowCutBypassed = true;
+		settings.highCutBypassed = true;
+		settings.peakFreq = 200.f;
+		settings.peakGainInDecibels = 12.f;
+		settings.peakQuality = 2.f;
+		
+		ChainCoefficients chainCoefficients;
+		chainCoefficients.settings = settings;
+		designLowCutFilter(settings, sampleRate, chainCoefficients.lowCut);
+		designPeakFilter(settings, sampleRate, chainCoefficients.peak);
+		designHighCutFilter(settings, sampleRate, chainCoefficients.highCut);
+		
+		ChannelChainPool<float> pool;
+		pool.prepare(numChannels, blockSize);
+		installCoefficients(pool, chainCoefficients);
+		
+		CoefficientRamp ramp;
+		ramp.reset(chainCoefficients);
+		
+		juce::dsp::AudioBlock<float> block(buffer);
+		
+		for (int i = 0; i < numBlocks; ++i) {
+			settings.peakFreq = 200.f * std::pow(40.f, float(i + 1) / float(numBlocks));
+			ramp.process(pool, block.getSubBlock((size_t) (i * blockSize), (size_t) blockSize), settings, sampleRate, subBlockSize);
+		}
+		
+		return buffer;
+	}
+	
+	// rms of the difference, relative to the rms of the reference
+	static double getErrorInDecibels(const juce::AudioBuffer<float> &output, const juce::AudioBuffer<float> &reference) {
+		double error = 0, signal = 0;
+		
+		for (int channel = 0; channel < numChannels; ++channel) {
+			for (int i = 0; i < output.getNumSamples(); ++i) {
+				auto difference = double(output.getSample(channel, i)) - reference.getSample(channel, i);
+				error += difference * difference;
+				signal += double(reference.getSample(channel, i)) * reference.getSample(channel, i);
+			}
+		}
+		
+		return 10.0 * std::log10(juce::jmax(error, 1e-30) / signal);
+	}
+	
+	static void fillWithNoise(juce::AudioBuffer<float> &buffer) {
+		juce::Random random(1234);
+		
+		for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+			for (int i = 0; i < buffer.getNumSamples(); ++i)
+				buffer.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+	}
+};
+
+static CoefficientRampBenchmark coefficientRampBenchmark;
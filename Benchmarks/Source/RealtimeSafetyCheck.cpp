@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    RealtimeSafetyCheck.cpp
+    Runs the processor through automation and mode changes and fails on any allocation or lock in processBlock.
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafetyCheck.h"
+
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/RealtimeSafety.h"
+
+#include <iostream>
+
+namespace {
+	struct Scenario {
+		const char *name;
+		std::function<void (SimpleEQAudioProcessor &)> setUp;
+		bool doublePrecision = false;
+		
+		// the host sends more samples per block than it announced in prepareToPlay
+		bool oversizedBlocks = false;
+	};
+	
+	void setParameter(SimpleEQAudioProcessor &processor, const juce::String &id, float value) {
+		auto *parameter = processor.apvts.getParameter(id);
+		parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+	}
+	
+	template<typename SampleType>
+	void runBlocks(SimpleEQAudioProcessor &processor, int blockSize) {
+		juce::AudioBuffer<SampleType> buffer(processor.getTotalNumOutputChannels(), blockSize);
+		juce::MidiBuffer midi;
+		juce::Random random(1234);
+		
+		for (int block = 0; block < 400; ++block) {
+			for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+				for (int i = 0; i < blockSize; ++i)
+					buffer.setSample(channel, i, SampleType(random.nextFloat() * 2.f - 1.f));
+			
+			// automation the way a host sends it, between blocks on the message thread
+			setParameter(processor, "Peak Freq", 200.f * std::pow(40.f, float(block % 100) / 100.f));
+			setParameter(processor, "LowCut Freq", 20.f + float(block % 50) * 4.f);
+			
+			if (block % 50 == 0) {
+				setParameter(processor, "LowCut Slope", float((block / 50) % 4));
+				setParameter(processor, "HighCut Bypassed", (block / 50) % 2 == 0 ? 1.f : 0.f);
+			}
+			
+			// lets the design thread publish now and then
+			if (block % 10 == 0)
+				juce::Thread::sleep(5);
+			
+			processor.processBlock(buffer, midi);
+		}
+	}
+}
+
+int runRealtimeSafetyCheck() {
+	if (! RealtimeSafety::isEnabled()) {
+		std::cout << "this build can't check, build it with SIMPLEEQ_RT_SAFETY_CHECKS=1 (the RealtimeChecks configuration)" << std::endl;
+		return 2;
+	}
+	
+	const std::vector<Scenario> scenarios {
+		{ "default", [](SimpleEQAudioProcessor &) { } },
+		{ "coefficient ramp", [](SimpleEQAudioProcessor &p) { p.setCoefficientRampSubBlockSize(32); } },
+		{ "coefficient tables", [](SimpleEQAudioProcessor &p) { p.setUsesCoefficientTables(true); } },
+		{ "coefficient ramp with tables", [](SimpleEQAudioProcessor &p) { p.setCoefficientRampSubBlockSize(32); p.setUsesCoefficientTables(true); } },
+		{ "4x oversampling", [](SimpleEQAudioProcessor &p) { p.setOversamplingOrder(2); } },
+		{ "4x oversampling, oversized blocks", [](SimpleEQAudioProcessor &p) { p.setOversamplingOrder(2); }, false, true },
+		{ "linear phase", [](SimpleEQAudioProcessor &p) { p.setUsesLinearPhase(true); } },
+		{ "double precision", [](SimpleEQAudioProcessor &) { }, true }
+	};
+	
+	constexpr double sampleRate = 48000.0;
+	constexpr int blockSize = 256;
+	
+	auto failed = false;
+	
+	for (auto &scenario : scenarios) {
+		SimpleEQAudioProcessor processor;
+		processor.setProcessingPrecision(scenario.doublePrecision ? juce::AudioProcessor::doublePrecision : juce::AudioProcessor::singlePrecision);
+		processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+		scenario.setUp(processor);
+		processor.prepareToPlay(sampleRate, blockSize);
+		
+		RealtimeSafety::resetReport();
+		
+		const auto hostBlockSize = scenario.oversizedBlocks ? blockSize * 3 + 7 : blockSize;
+		
+		if (scenario.doublePrecision)
+			runBlocks<double>(processor, hostBlockSize);
+		else
+			runBlocks<float>(processor, hostBlockSize);
+		
+		const auto report = RealtimeSafety::getReport();
+		
+		std::cout << scenario.name << ": " << report.numBlocksWithViolations << " of " << report.numBlocks << " blocks with violations, "
+				  << report.numAllocations << " allocations, " << report.numDeallocations << " deallocations, " << report.numLocks << " locks"
+				  << ", at most " << report.mostViolationsInOneBlock << " in one block" << std::endl;
+		
+		for (auto &violation : report.recentViolations)
+			std::cout << "  " << RealtimeSafety::describe(violation) << std::endl;
+		
+		failed = failed || report.getNumViolations() > 0;
+	}
+	
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,13 @@
+/*
+  ==============================================================================
+
+    RealtimeSafetyCheck.h
+    Runs the processor through automation and mode changes and fails on any allocation or lock in processBlock.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/** returns 0 when processBlock stayed clean, 1 on violations, 2 when the build can't check */
+int runRealtimeSafetyCheck();
@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    CpuLoadMeter.h
+    How much of each block's deadline processBlock used, over the last few seconds.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+
+/* the audio thread adds one entry per block to a ring, any other thread can read a snapshot of it.
+ * load is the time processBlock took over the time the block's samples last, so 100% is a missed deadline.
+ * both are measured with the high resolution tick counter, which is a couple of ns to read on current systems.
+ * the coefficient share is the part of that spent designing coefficients on the audio thread,
+ * in the ramp or offline in updateFilters(). */
+struct CpuLoadMeter {
+	// 5% wide bins up to 100%, the last one holds the overruns
+	static constexpr int numBins = 21;
+	static constexpr int binWidthInPercent = 5;
+	
+	// about 5 seconds of 512 sample blocks at 48 kHz
+	static constexpr int numRecentBlocks = 512;
+	
+	struct Snapshot {
+		std::array<int, numBins> histogram {};
+		int numBlocks = 0;
+		
+		// all in percent of the deadline, the coefficient share in percent of the time processBlock took
+		float averageLoad = 0, peakLoad = 0, coefficientShare = 0;
+		
+		// since prepare, not just the recent blocks
+		juce::int64 totalBlocks = 0, totalOverruns = 0;
+	};
+	
+	/** message thread, before processing starts */
+	void prepare(double sampleRate) {
+		ticksPerSample = double(juce::Time::getHighResolutionTicksPerSecond()) / sampleRate;
+		
+		for (auto &entry : recent)
+			entry = 0;
+		
+		numWritten = 0;
+		totalBlocks = 0;
+		totalOverruns = 0;
+	}
+	
+	/** audio thread, once per block */
+	void addBlock(juce::int64 blockTicks, juce::int64 coefficientTicks, int numSamples) noexcept {
+		if (numSamples <= 0 || ticksPerSample <= 0)
+			return;
+		
+		const auto load = double(blockTicks) / (ticksPerSample * numSamples);
+		const auto share = blockTicks > 0 ? double(coefficientTicks) / double(blockTicks) : 0.0;
+		
+		// load in 0.1% steps in the low half, the coefficient share in 1% steps in the high half
+		const auto loadPermille = (juce::uint32) juce::jlimit(0.0, 65535.0, load * 1000.0 + 0.5);
+		const auto sharePercent = (juce::uint32) juce::jlimit(0.0, 100.0, share * 100.0 + 0.5);
+		
+		const auto index = numWritten.load(std::memory_order_relaxed);
+		recent[index % numRecentBlocks].store(loadPermille | (sharePercent << 16), std::memory_order_relaxed);
+		numWritten.store(index + 1, std::memory_order_release);
+		
+		totalBlocks.fetch_add(1, std::memory_order_relaxed);
+		
+		if (load >= 1.0)
+			totalOverruns.fetch_add(1, std::memory_order_relaxed);
+	}
+	
+	/** any thread. entries being overwritten meanwhile just count as recent blocks */
+	Snapshot getSnapshot() const {
+		Snapshot snapshot;
+		
+		const auto written = numWritten.load(std::memory_order_acquire);
+		snapshot.numBlocks = (int) juce::jmin(written, (juce::uint32) numRecentBlocks);
+		snapshot.totalBlocks = totalBlocks.load(std::memory_order_relaxed);
+		snapshot.totalOverruns = totalOverruns.load(std::memory_order_relaxed);
+		
+		auto loadSum = 0.0, shareSum = 0.0;
+		
+		for (int i = 0; i < snapshot.numBlocks; ++i) {
+			const auto entry = recent[(size_t) i].load(std::memory_order_relaxed);
+			const auto load = float(entry & 0xffff) / 10.f;
+			
+			++snapshot.histogram[(size_t) juce::jmin(numBins - 1, int(load) / binWidthInPercent)];
+			
+			loadSum += load;
+			shareSum += entry >> 16;
+			snapshot.peakLoad = juce::jmax(snapshot.peakLoad, load);
+		}
+		
+		if (snapshot.numBlocks > 0) {
+			snapshot.averageLoad = float(loadSum / snapshot.numBlocks);
+			snapshot.coefficientShare = float(shareSum / snapshot.numBlocks);
+		}
+		
+		return snapshot;
+	}
+	
+	/** a few lines of text, for logs and batch reports */
+	juce::String describe() const {
+		const auto snapshot = getSnapshot();
+		
+		juce::String text;
+		text << "cpu load over the last " << snapshot.numBlocks << " blocks: " << juce::String(snapshot.averageLoad, 1) << "% average, "
+			 << juce::String(snapshot.peakLoad, 1) << "% peak, " << juce::String(snapshot.coefficientShare, 1) << "% of it designing coefficients\n"
+			 << snapshot.totalOverruns << " of " << snapshot.totalBlocks << " blocks overran their deadline\n";
+		
+		for (int bin = 0; bin < numBins; ++bin) {
+			if (snapshot.histogram[(size_t) bin] == 0)
+				continue;
+			
+			text << (bin < numBins - 1 ? juce::String(bin * binWidthInPercent) + "-" + juce::String((bin + 1) * binWidthInPercent) + "%" : juce::String("overrun"))
+				 << ": " << snapshot.histogram[(size_t) bin] << "\n";
+		}
+		
+		return text;
+	}
+	
+private:
+	double ticksPerSample = 0;
+	
+	std::array<std::atomic<juce::uint32>, numRecentBlocks> recent {};
+	std::atomic<juce::uint32> numWritten { 0 };
+	std::atomic<juce::int64> totalBlocks { 0 }, totalOverruns { 0 };
+};
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    FilterDesign.cpp
+    Closed form biquad designs that write straight into fixed size sections.
+
+  ==============================================================================
+*/
+
+#include "FilterDesign.h"
+
+#include <cmath>
+#include <complex>
+
+namespace {
+	/* 1 / Q of every section of an even order butterworth filter, 2 * cos((2i + 1) * pi / (2 * order)).
+	 * one row per number of sections, the same values juce::dsp::FilterDesign computes per call */
+	constexpr double butterworthInverseQs[CutCoefficients::maxNumSections][CutCoefficients::maxNumSections] {
+		{ 1.4142135623730951 },
+		{ 1.8477590650225735, 0.76536686473017967 },
+		{ 1.9318516525781366, 1.4142135623730951, 0.51763809020504148 },
+		{ 1.9615705608064609, 1.6629392246050905, 1.1111404660392046, 0.39018064403225666 }
+	};
+}
+
+void designButterworthHighPass(CutCoefficients &cut, double frequency, double sampleRate, int numSections) {
+	jassert(sampleRate > 0);
+	jassert(frequency > 0 && frequency <= sampleRate * 0.5);
+	jassert(numSections > 0 && numSections <= CutCoefficients::maxNumSections);
+	
+	const auto n = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+	const auto nSquared = n * n;
+	const auto *inverseQs = butterworthInverseQs[numSections - 1];
+	
+	for (int i = 0; i < numSections; ++i) {
+		const auto invQ = inverseQs[i];
+		const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+		
+		auto &section = cut.sections[(size_t) i];
+		section.b0 = c1;
+		section.b1 = c1 * -2.0;
+		section.b2 = c1;
+		section.a1 = c1 * 2.0 * (nSquared - 1.0);
+		section.a2 = c1 * (1.0 - invQ * n + nSquared);
+	}
+	
+	cut.numSections = numSections;
+}
+
+void designButterworthLowPass(CutCoefficients &cut, double frequency, double sampleRate, int numSections) {
+	jassert(sampleRate > 0);
+	jassert(frequency > 0 && frequency <= sampleRate * 0.5);
+	jassert(numSections > 0 && numSections <= CutCoefficients::maxNumSections);
+	
+	const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+	const auto nSquared = n * n;
+	const auto *inverseQs = butterworthInverseQs[numSections - 1];
+	
+	for (int i = 0; i < numSections; ++i) {
+		const auto invQ = inverseQs[i];
+		const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+		
+		auto &section = cut.sections[(size_t) i];
+		section.b0 = c1;
+		section.b1 = c1 * 2.0;
+		section.b2 = c1;
+		section.a1 = c1 * 2.0 * (1.0 - nSquared);
+		section.a2 = c1 * (1.0 - invQ * n + nSquared);
+	}
+	
+	cut.numSections = numSections;
+}
+
+void designPeakFilter(BiquadCoefficients &peak, double frequency, double sampleRate, double quality, double gainFactor) {
+	jassert(sampleRate > 0);
+	jassert(quality > 0);
+	
+	const auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+	const auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0)) / sampleRate;
+	const auto alpha = std::sin(omega) / (quality * 2.0);
+	const auto c2 = -2.0 * std::cos(omega);
+	const auto alphaTimesA = alpha * A;
+	const auto alphaOverA = alpha / A;
+	
+	const auto invA0 = 1.0 / (1.0 + alphaOverA);
+	
+	peak.b0 = (1.0 + alphaTimesA) * invA0;
+	peak.b1 = c2 * invA0;
+	peak.b2 = (1.0 - alphaTimesA) * invA0;
+	peak.a1 = c2 * invA0;
+	peak.a2 = (1.0 - alphaOverA) * invA0;
+}
+
+double getMagnitudeForFrequency(const BiquadCoefficients &section, double frequency, double sampleRate) {
+	jassert(sampleRate > 0);
+	
+	// H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2) on the unit circle
+	const auto z1 = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+	const auto z2 = z1 * z1;
+	
+	return std::abs(section.b0 + section.b1 * z1 + section.b2 * z2) / std::abs(1.0 + section.a1 * z1 + section.a2 * z2);
+}
+
+double getMagnitudeForFrequency(const CutCoefficients &cut, double frequency, double sampleRate) {
+	auto magnitude = 1.0;
+	
+	for (int i = 0; i < cut.numSections; ++i)
+		magnitude *= getMagnitudeForFrequency(cut.sections[(size_t) i], frequency, sampleRate);
+	
+	return magnitude;
+}
+
+//==============================================================================
+CutCoefficientTable::CutCoefficientTable(double rate) : sampleRate(rate) {
+	const auto start = juce::Time::getMillisecondCounterHiRes();
+	
+	highPass.resize((size_t) numFrequencies * sectionsPerFrequency);
+	lowPass.resize((size_t) numFrequencies * sectionsPerFrequency);
+	
+	// frequencies above nyquist (rates below 40 kHz) can't be designed, they get the highest one that can
+	const auto highestFrequency = sampleRate * 0.499;
+	
+	CutCoefficients cut;
+	
+	for (int i = 0; i < numFrequencies; ++i) {
+		const auto frequency = juce::jmin(double(minFrequency + i), highestFrequency);
+		auto *highPassEntry = highPass.data() + (size_t) i * sectionsPerFrequency;
+		auto *lowPassEntry = lowPass.data() + (size_t) i * sectionsPerFrequency;
+		
+		for (int numSections = 1; numSections <= CutCoefficients::maxNumSections; ++numSections) {
+			designButterworthHighPass(cut, frequency, sampleRate, numSections);
+			highPassEntry = std::copy(cut.sections.begin(), cut.sections.begin() + numSections, highPassEntry);
+			
+			designButterworthLowPass(cut, frequency, sampleRate, numSections);
+			lowPassEntry = std::copy(cut.sections.begin(), cut.sections.begin() + numSections, lowPassEntry);
+		}
+	}
+	
+	buildTimeMs = juce::Time::getMillisecondCounterHiRes() - start;
+}
+
+void CutCoefficientTable::lookupHighPass(CutCoefficients &cut, double frequency, int numSections) const {
+	lookup(highPass, cut, frequency, numSections);
+}
+
+void CutCoefficientTable::lookupLowPass(CutCoefficients &cut, double frequency, int numSections) const {
+	lookup(lowPass, cut, frequency, numSections);
+}
+
+void CutCoefficientTable::lookup(const std::vector<BiquadCoefficients> &table, CutCoefficients &cut, double frequency, int numSections) {
+	jassert(numSections > 0 && numSections <= CutCoefficients::maxNumSections);
+	
+	const auto index = juce::jlimit(0, numFrequencies - 1, juce::roundToInt(frequency) - minFrequency);
+	
+	// the sections of n-section designs start after those of all the smaller ones: 0, 1, 3, 6
+	const auto offset = (numSections - 1) * numSections / 2;
+	const auto *entry = table.data() + (size_t) index * sectionsPerFrequency + (size_t) offset;
+	
+	std::copy(entry, entry + numSections, cut.sections.begin());
+	cut.numSections = numSections;
+}
+
+size_t CutCoefficientTable::getMemoryUsageInBytes() const {
+	return sizeof(*this) + (highPass.capacity() + lowPass.capacity()) * sizeof(BiquadCoefficients);
+}
+
+std::shared_ptr<const CutCoefficientTable> CutCoefficientTableCache::getTable(double sampleRate) {
+	const juce::ScopedLock sl(lock);
+	
+	for (auto &weakTable : tables)
+		if (auto table = weakTable.lock())
+			if (table->getSampleRate() == sampleRate)
+				return table;
+	
+	// forget the tables nobody uses any more before adding the new one
+	tables.erase(std::remove_if(tables.begin(), tables.end(), [](const auto &weakTable) { return weakTable.expired(); }), tables.end());
+	
+	auto table = std::make_shared<const CutCoefficientTable>(sampleRate);
+	tables.push_back(table);
+	
+	return table;
+}
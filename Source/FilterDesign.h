@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    FilterDesign.h
+    Closed form biquad designs that write straight into fixed size sections.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+/* one second-order section with a0 already divided out.
+ * the order matches the raw coefficients of a second-order juce::dsp::IIR::Coefficients: b0 b1 b2 a1 a2 */
+struct BiquadCoefficients {
+	double b0 { 1 }, b1 { 0 }, b2 { 0 }, a1 { 0 }, a2 { 0 };
+};
+
+/* the sections of one butterworth cut filter, only the first numSections are in use */
+struct CutCoefficients {
+	static constexpr int maxNumSections = 4;
+	
+	std::array<BiquadCoefficients, maxNumSections> sections;
+	int numSections { 0 };
+};
+
+/* these produce the same filters as juce::dsp::FilterDesign / juce::dsp::IIR::Coefficients,
+ * but without touching the heap, so they're safe to call at audio rate.
+ * every section of a butterworth cascade shares the same prewarped frequency, only the Q differs,
+ * and the Qs only depend on the order, so they come from a table instead of being recomputed. */
+void designButterworthHighPass(CutCoefficients &, double frequency, double sampleRate, int numSections);
+void designButterworthLowPass(CutCoefficients &, double frequency, double sampleRate, int numSections);
+
+void designPeakFilter(BiquadCoefficients &, double frequency, double sampleRate, double quality, double gainFactor);
+
+/* the gain of a design at a frequency, what juce::dsp::IIR::Coefficients::getMagnitudeForFrequency gives for the same filter */
+double getMagnitudeForFrequency(const BiquadCoefficients &, double frequency, double sampleRate);
+double getMagnitudeForFrequency(const CutCoefficients &, double frequency, double sampleRate);
+
+/* every cut filter design for one sample rate.
+ * the cut frequencies are quantised to 1 Hz between 20 Hz and 20 kHz and there are only four slopes,
+ * so the whole design space fits in a table and designing becomes an index lookup. */
+struct CutCoefficientTable {
+	static constexpr int minFrequency = 20, maxFrequency = 20000;
+	static constexpr int numFrequencies = maxFrequency - minFrequency + 1;
+	
+	explicit CutCoefficientTable(double sampleRate);
+	
+	void lookupHighPass(CutCoefficients &, double frequency, int numSections) const;
+	void lookupLowPass(CutCoefficients &, double frequency, int numSections) const;
+	
+	double getSampleRate() const { return sampleRate; }
+	size_t getMemoryUsageInBytes() const;
+	double getBuildTimeInMilliseconds() const { return buildTimeMs; }
+	
+private:
+	// per frequency the sections of every order follow each other, 1 + 2 + 3 + 4 of them
+	static constexpr int sectionsPerFrequency = 10;
+	
+	double sampleRate, buildTimeMs { 0 };
+	std::vector<BiquadCoefficients> highPass, lowPass;
+	
+	static void lookup(const std::vector<BiquadCoefficients> &, CutCoefficients &, double frequency, int numSections);
+};
+
+/* hands out the table for a sample rate, building it on first use.
+ * every instance running at the same rate shares one table, it's freed once nobody holds it any more.
+ * use it through a juce::SharedResourcePointer. */
+struct CutCoefficientTableCache {
+	std::shared_ptr<const CutCoefficientTable> getTable(double sampleRate);
+	
+private:
+	juce::CriticalSection lock;
+	std::vector<std::weak_ptr<const CutCoefficientTable>> tables;
+};
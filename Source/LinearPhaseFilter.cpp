@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    LinearPhaseFilter.cpp
+    The eq's magnitude response as a linear phase FIR, run through FFT convolution.
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseFilter.h"
+
+int LinearPhaseFilter::getValidKernelLength(int length) {
+	return juce::nextPowerOfTwo(juce::jlimit(minKernelLength, maxKernelLength, length));
+}
+
+void LinearPhaseFilter::prepare(int numChannels, int maximumBlockSizeToUse, double sampleRateToUse, int kernelLengthToUse) {
+	convolutions.clear();
+	fft.reset();
+	
+	if (numChannels <= 0) {
+		kernelLength = 0;
+		conversionBuffer.setSize(0, 0);
+		return;
+	}
+	
+	sampleRate = sampleRateToUse;
+	maximumBlockSize = maximumBlockSizeToUse;
+	kernelLength = getValidKernelLength(kernelLengthToUse);
+	
+	for (int first = 0; first < numChannels; first += 2) {
+		juce::dsp::ProcessSpec spec;
+		spec.sampleRate = sampleRate;
+		spec.maximumBlockSize = (juce::uint32) maximumBlockSize;
+		spec.numChannels = (juce::uint32) juce::jmin(2, numChannels - first);
+		
+		auto convolution = std::make_unique<juce::dsp::Convolution>(juce::dsp::Convolution::Latency { 0 }, messageQueue);
+		convolution->prepare(spec);
+		convolutions.push_back(std::move(convolution));
+	}
+	
+	conversionBuffer.setSize(numChannels, maximumBlockSize);
+	
+	fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(kernelLength)));
+	fftData.assign((size_t) kernelLength * 2, 0.f);
+	
+	// one longer than the kernel, so the window is symmetric around the middle sample
+	window.assign((size_t) kernelLength + 1, 0.f);
+	juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), window.size(), juce::dsp::WindowingFunction<float>::blackman, false);
+}
+
+void LinearPhaseFilter::reset() {
+	for (auto &convolution : convolutions)
+		convolution->reset();
+}
+
+void LinearPhaseFilter::loadKernel(const std::function<double (double frequency)> &getMagnitudeForFrequency) {
+	if (fft == nullptr)
+		return;
+	
+	// zero phase, only the real part of each bin is set
+	std::fill(fftData.begin(), fftData.end(), 0.f);
+	
+	for (int bin = 0; bin <= kernelLength / 2; ++bin)
+		fftData[(size_t) bin * 2] = (float) getMagnitudeForFrequency(bin * sampleRate / kernelLength);
+	
+	fft->performRealOnlyInverseTransform(fftData.data());
+	
+	// the zero phase response is centred on sample 0, rotating by half the length makes it causal
+	juce::AudioBuffer<float> kernel(1, kernelLength);
+	
+	for (int i = 0; i < kernelLength; ++i)
+		kernel.setSample(0, i, fftData[(size_t) ((i + kernelLength / 2) % kernelLength)] * window[(size_t) i]);
+	
+	for (auto &convolution : convolutions) {
+		juce::AudioBuffer<float> copy(kernel);
+		convolution->loadImpulseResponse(std::move(copy), sampleRate, juce::dsp::Convolution::Stereo::no,
+										 juce::dsp::Convolution::Trim::no, juce::dsp::Convolution::Normalise::no);
+	}
+}
+
+void LinearPhaseFilter::processFloat(const juce::dsp::AudioBlock<float> &block) noexcept {
+	const auto numChannels = block.getNumChannels();
+	
+	for (size_t start = 0; start < block.getNumSamples(); start += (size_t) maximumBlockSize) {
+		auto subBlock = block.getSubBlock(start, juce::jmin((size_t) maximumBlockSize, block.getNumSamples() - start));
+		
+		for (size_t first = 0, index = 0; first < numChannels && index < convolutions.size(); first += 2, ++index) {
+			auto pair = subBlock.getSubsetChannelBlock(first, juce::jmin((size_t) 2, numChannels - first));
+			convolutions[index]->process(juce::dsp::ProcessContextReplacing<float>(pair));
+		}
+	}
+}
@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    LinearPhaseFilter.h
+    The eq's magnitude response as a linear phase FIR, run through FFT convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+/* the magnitude response is sampled on the FFT bins, given zero phase, turned into an impulse response,
+ * moved to the middle of the kernel and windowed. every frequency is then delayed by the same
+ * kernelLength / 2 samples, that's the latency.
+ * juce::dsp::Convolution runs the kernel as a uniformly partitioned FFT convolution, using the fastest FFT
+ * the platform has. it swaps kernels with a crossfade and loads them on its own background thread,
+ * so a new kernel can be handed over while audio is running. */
+struct LinearPhaseFilter {
+	static constexpr int minKernelLength = 1024, maxKernelLength = 16384;
+	
+	/** rounds up to the next power of two in range */
+	static int getValidKernelLength(int kernelLength);
+	
+	/** allocates, so only ever from the message thread. 0 channels releases everything */
+	void prepare(int numChannels, int maximumBlockSize, double sampleRate, int kernelLength);
+	void reset();
+	
+	/** builds a kernel from the magnitude at a frequency in Hz and hands it to the convolvers.
+	 * allocates as well, so from anywhere but the audio thread */
+	void loadKernel(const std::function<double (double frequency)> &getMagnitudeForFrequency);
+	
+	template<typename SampleType>
+	void process(const juce::dsp::AudioBlock<SampleType> &block) noexcept {
+		if (convolutions.empty())
+			return;
+		
+		if constexpr (std::is_same_v<SampleType, float>) {
+			processFloat(block);
+		} else {
+			// the convolution only runs on floats
+			const auto numChannels = juce::jmin(block.getNumChannels(), (size_t) conversionBuffer.getNumChannels());
+			
+			for (size_t start = 0; start < block.getNumSamples(); start += (size_t) maximumBlockSize) {
+				const auto numSamples = juce::jmin((size_t) maximumBlockSize, block.getNumSamples() - start);
+				
+				for (size_t channel = 0; channel < numChannels; ++channel) {
+					const auto *source = block.getChannelPointer(channel) + start;
+					auto *floats = conversionBuffer.getWritePointer((int) channel);
+					
+					for (size_t i = 0; i < numSamples; ++i)
+						floats[i] = (float) source[i];
+				}
+				
+				processFloat(juce::dsp::AudioBlock<float>(conversionBuffer).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples));
+				
+				for (size_t channel = 0; channel < numChannels; ++channel) {
+					const auto *floats = conversionBuffer.getReadPointer((int) channel);
+					auto *destination = block.getChannelPointer(channel) + start;
+					
+					for (size_t i = 0; i < numSamples; ++i)
+						destination[i] = floats[i];
+				}
+			}
+		}
+	}
+	
+	int getKernelLength() const { return kernelLength; }
+	int getLatencyInSamples() const { return kernelLength / 2; }
+	
+private:
+	double sampleRate = 0;
+	int kernelLength = 0, maximumBlockSize = 0;
+	
+	// shared by the convolvers for loading kernels, declared first so it outlives them
+	juce::dsp::ConvolutionMessageQueue messageQueue;
+	
+	// one convolution handles up to two channels, so there's one per pair
+	std::vector<std::unique_ptr<juce::dsp::Convolution>> convolutions;
+	juce::AudioBuffer<float> conversionBuffer;
+	
+	std::unique_ptr<juce::dsp::FFT> fft;
+	std::vector<float> fftData, window;
+	
+	void processFloat(const juce::dsp::AudioBlock<float> &block) noexcept;
+};
@@ -195,74 +195,218 @@ juce::String RotarySliderWithLabels::getDisplayString() const {
 //==============================================================================
 ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor &p) : audioProcessor(p),
 //	leftChannelFifo(&audioProcessor.leftChannelFifo)
-leftPathProducer(audioProcessor.leftChannelFifo),
-rightPathProducer(audioProcessor.rightChannelFifo) {
-	const auto &params = audioProcessor.getParameters();
-	
-	for (auto param : params) {
-		param->addListener(this);
-	}
-	
+pathProducer(audioProcessor.leftChannelFifo, audioProcessor.rightChannelFifo) {
 	/* basic math explanation...
 	 * 44100 sample rate / 2048 = 21.53Hz per equal bin */
 	
-	updateChain();
+	updateChain(audioProcessor.chainParameters.getGenerations());
+	
+	analyzerThread->add(&pathProducer);
 	
 	startTimerHz(60);
 }
 
 ResponseCurveComponent::~ResponseCurveComponent() {
-	const auto &params = audioProcessor.getParameters();
+	analyzerThread->remove(&pathProducer);
+}
+
+void ResponseCurveComponent::toggleAnalysisEnablement(bool enabled) {
+	shouldShowFFTAnalysis = enabled;
+	
+	// a disabled analyzer costs nothing, its taps just overrun
+	if (enabled)
+		analyzerThread->add(&pathProducer);
+	else
+		analyzerThread->remove(&pathProducer);
+}
+
+void PathProducer::setAnalysisArea(juce::Rectangle<float> fftBounds, double sampleRate) {
+	const juce::ScopedLock sl(areaLock);
 	
-	for (auto param : params) {
-		param->removeListener(this);
-	}
+	analysisArea = fftBounds;
+	analysisSampleRate = sampleRate;
 }
 
-void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue) {
-	parametersChanged.set(true);
+void PathProducer::setAnalysisSettings(FFTOrder order, int overlap, AnalyzerMode mode) {
+	const juce::ScopedLock sl(areaLock);
+	
+	analysisOrder = order;
+	analysisOverlap = juce::jmax(1, overlap);
+	analysisMode = mode;
 }
 
-void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate) {
-	juce::AudioBuffer<float> tempIncomingBuffer;
+void PathProducer::changeOrder(FFTOrder order) {
+	fftDataGenerator.changeOrder(order);
 	
-	while (leftChannelFifo->getNumCompleteBuffersAvailable() > 0) {
-		if (leftChannelFifo->getAudioBuffer(tempIncomingBuffer)) {
-			auto size = tempIncomingBuffer.getNumSamples();
-			
-			// shift over data
-			juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
-											  monoBuffer.getReadPointer(0, size),
-											  monoBuffer.getNumSamples() - size);
-											  
-			// copy to end (moving right to left with new data)
-			juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
-											  tempIncomingBuffer.getReadPointer(0, 0),
-											  size);
-											  
-			leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
-		}
+	// starts out silent, the windows fill up again from the next samples on
+	for (auto &channel : channels) {
+		channel.monoBuffer.setSize(1, fftDataGenerator.getFFTSize());
+		channel.monoBuffer.clear();
+	}
+	
+	writePosition = 0;
+	
+	spectrum.clear();
+}
+
+/* folds one frame into the spectrum with a vectorised pass, how depends on the mode.
+ * the average and the peak decay are set in seconds, so they behave the same at any FFT rate */
+void PathProducer::accumulate(const std::vector<float> &fftData, AnalyzerMode mode, double frameSeconds) {
+	// both channels' bins
+	const auto numBins = fftDataGenerator.getFFTSize();
+	
+	// a new size or mode starts over from this frame
+	if ((int) spectrum.size() != numBins || spectrumMode != mode || mode == AnalyzerMode::Instant) {
+		spectrum.assign(fftData.begin(), fftData.begin() + numBins);
+		spectrumMode = mode;
+		return;
+	}
+	
+	if (mode == AnalyzerMode::Average) {
+		// spectrum += (frame - spectrum) * amount
+		const auto amount = float(1.0 - std::exp(-frameSeconds / averagingTimeSeconds));
+		
+		juce::FloatVectorOperations::multiply(spectrum.data(), 1.f - amount, numBins);
+		juce::FloatVectorOperations::addWithMultiply(spectrum.data(), fftData.data(), amount, numBins);
+	} else {
+		// the held peak falls back until a louder frame pushes it up again
+		juce::FloatVectorOperations::add(spectrum.data(), float(-peakDecayDecibelsPerSecond * frameSeconds), numBins);
+		juce::FloatVectorOperations::max(spectrum.data(), spectrum.data(), fftData.data(), numBins);
 	}
+}
+
+void PathProducer::process() {
+	juce::Rectangle<float> fftBounds;
+	double sampleRate;
+	FFTOrder order;
+	int overlap;
+	AnalyzerMode mode;
+	
+	{
+		const juce::ScopedLock sl(areaLock);
+		
+		fftBounds = analysisArea;
+		sampleRate = analysisSampleRate;
+		order = analysisOrder;
+		overlap = analysisOverlap;
+		mode = analysisMode;
+	}
+	
+	if (fftBounds.isEmpty() || sampleRate <= 0)
+		return;
 	
-//	const auto fftBounds = getAnalysisArea().toFloat();
-	const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
+	if (1 << order != fftDataGenerator.getFFTSize())
+		changeOrder(order);
+	
+	const auto fftSize = fftDataGenerator.getFFTSize();
+	const auto numBins = fftSize / 2;
 	
 	/* bin width (44100 / 2048) -> sample rate / fftsize */
 	const auto binWidth = sampleRate / (double)fftSize;
 	
-	/* if there are FFT data buffers to pull
-		if we can pull them
-			generate path */
-	while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0) {
-		std::vector<float> fftData;
+	auto &left = channels[Channel::Left];
+	auto &right = channels[Channel::Right];
+	
+	const juce::ScopedLock leftLock(left.fifo->getReadLock());
+	const juce::ScopedLock rightLock(right.fifo->getReadLock());
+	
+	if (! left.fifo->isPrepared() || ! right.fifo->isPrepared())
+		return;
+	
+	const auto start = juce::Time::getHighResolutionTicks();
+	
+	// a new FFT every hop's worth of samples, read straight out of the taps' rings.
+	// the hop only depends on the analysis settings, the host's block size doesn't come into it
+	auto numFrames = 0;
+	const auto hopSize = fftSize / overlap;
+	const auto frameSeconds = hopSize / sampleRate;
+	
+	auto numSamplesAvailable = [&] {
+		return juce::jmin(left.fifo->getNumSamplesAvailable(), right.fifo->getNumSamplesAvailable());
+	};
+	
+	while (hopSize > 0 && numSamplesAvailable() >= hopSize) {
+		for (auto &channel : channels) {
+			auto incoming = channel.fifo->getReadSpans(hopSize);
+			
+			auto *monoData = channel.monoBuffer.getWritePointer(0);
+			auto position = writePosition;
+			
+			// each new sample is written once, over the oldest one. the ring's two pieces may wrap here as well
+			for (auto [data, numSamples] : { std::pair { incoming.data1, incoming.size1 }, std::pair { incoming.data2, incoming.size2 } }) {
+				while (numSamples > 0) {
+					const auto numToCopy = juce::jmin(numSamples, fftSize - position);
+					juce::FloatVectorOperations::copy(monoData + position, data, numToCopy);
+					
+					data += numToCopy;
+					numSamples -= numToCopy;
+					position = (position + numToCopy) % fftSize;
+				}
+			}
+			
+			channel.fifo->finishedRead(hopSize);
+		}
+		
+		writePosition = (writePosition + hopSize) % fftSize;
+		
+		// the windows run from the oldest sample, at writePosition, round to the newest
+		fftDataGenerator.produceStereoFFTDataForRendering(left.monoBuffer.getReadPointer(0), right.monoBuffer.getReadPointer(0), writePosition, -48.f);
+		++numFrames;
 		
-		if (leftChannelFFTDataGenerator.getFFTData(fftData)) {
-			pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);
+		// every frame is folded into the spectrum straight away, so the fifo never fills up
+		fftDataGenerator.readFFTData([&](const std::vector<float> &fftData) {
+			accumulate(fftData, mode, frameSeconds);
+			spectrumChanged = true;
+		});
+	}
+	
+	// one pair of paths per frame the editor picks up, however many FFTs went into them
+	if (spectrumChanged && ! spectrum.empty() && pathsWanted.exchange(false)) {
+		for (auto [channel, bins] : { std::pair { &left, spectrum.data() }, std::pair { &right, spectrum.data() + numBins } }) {
+			channel->pathGenerator.generatePath(bins, fftBounds, fftSize, binWidth, -48.f);
+			
+			while (channel->pathGenerator.getNumPathsAvailable())
+				channel->pathGenerator.getPath(channel->paths.getWriteBuffer());
+			
+			channel->paths.publish();
 		}
+		
+		spectrumChanged = false;
 	}
 	
-	while (pathProducer.getNumPathsAvailable()) {
-		pathProducer.getPath(leftChannelFFTPath);
+	numFFTs += numFrames;
+	analysisTicks += juce::Time::getHighResolutionTicks() - start;
+}
+
+AnalyzerThread::AnalyzerThread() : juce::Thread("SimpleEQ Analyzer") {
+	startThread();
+}
+
+AnalyzerThread::~AnalyzerThread() {
+	stopThread(1000);
+}
+
+void AnalyzerThread::add(PathProducer *producer) {
+	const juce::ScopedLock sl(lock);
+	producers.addIfNotAlreadyThere(producer);
+}
+
+void AnalyzerThread::remove(PathProducer *producer) {
+	// once this returns the thread can't be inside the producer any more
+	const juce::ScopedLock sl(lock);
+	producers.removeFirstMatchingValue(producer);
+}
+
+void AnalyzerThread::run() {
+	while (! threadShouldExit()) {
+		{
+			const juce::ScopedLock sl(lock);
+			
+			for (auto *producer : producers)
+				producer->process();
+		}
+		
+		wait(analysisIntervalMs);
 	}
 }
 
@@ -271,12 +415,22 @@ void ResponseCurveComponent::timerCallback() {
 		auto fftBounds = getAnalysisArea().toFloat();
 		auto sampleRate = audioProcessor.getSampleRate();
 		
-		leftPathProducer.process(fftBounds, sampleRate);
-		rightPathProducer.process(fftBounds, sampleRate);
+		// the analyzer thread does the work, this just keeps it up to date and picks up what it finished
+		pathProducer.setAnalysisArea(fftBounds, sampleRate);
+		
+		auto order = (FFTOrder) audioProcessor.getAnalyzerFFTOrder();
+		auto overlap = audioProcessor.getAnalyzerOverlap();
+		auto mode = (AnalyzerMode) audioProcessor.getAnalyzerMode();
+		
+		pathProducer.setAnalysisSettings(order, overlap, mode);
+		pathProducer.pullLatestPaths();
 	}
 
-	if (parametersChanged.compareAndSetBool(false, true)) {
-		updateChain();
+	auto generations = audioProcessor.chainParameters.getGenerations();
+	
+	// a new sample rate comes with every generation bumped, but the rate is checked too so neither can be missed
+	if (generations != chainGenerations || audioProcessor.getProcessingSampleRate() != chainSampleRate) {
+		updateChain(generations);
 		//signal repaint
 //		repaint();
 	}
@@ -284,80 +438,63 @@ void ResponseCurveComponent::timerCallback() {
 	repaint();
 }
 
-void ResponseCurveComponent::updateChain() {
-	//update monochain
-	auto chainSettings = getChainSettings(audioProcessor.apvts);
+void ResponseCurveComponent::updateChain(const ChainParameters::Generations &generations) {
+	//update the coefficients, only redesigning the bands that changed
+	auto chainSettings = audioProcessor.chainParameters.getSettings();
+	// designed like the processor's chain, which may be oversampled
+	auto sampleRate = audioProcessor.getProcessingSampleRate();
+	const auto sampleRateChanged = sampleRate != chainSampleRate;
 	
-	monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-	monoChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-	monoChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+	// with the tables on the processor runs cuts rounded to 1 Hz, the curve uses the same ones.
+	// swapping the table bumps the cut generations, so it's never newer than the generations read before it
+	auto cutTable = audioProcessor.getCutTable();
+	const auto cutTableChanged = cutTable != chainCutTable;
 	
-	auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-		
-	auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-	auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
-		
-	updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-		
-	updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-	updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+	chainCoefficients.settings = chainSettings;
+	
+	if (sampleRateChanged || generations[ChainPositions::Peak] != chainGenerations[ChainPositions::Peak])
+		designPeakFilter(chainSettings, sampleRate, chainCoefficients.peak);
+	
+	if (sampleRateChanged || cutTableChanged || generations[ChainPositions::LowCut] != chainGenerations[ChainPositions::LowCut])
+		designLowCutFilter(chainSettings, sampleRate, cutTable.get(), chainCoefficients.lowCut);
+	
+	if (sampleRateChanged || cutTableChanged || generations[ChainPositions::HighCut] != chainGenerations[ChainPositions::HighCut])
+		designHighCutFilter(chainSettings, sampleRate, cutTable.get(), chainCoefficients.highCut);
+	
+	chainGenerations = generations;
+	chainSampleRate = sampleRate;
+	chainCutTable = std::move(cutTable);
+	
+	responseCurveValid = false;
 }
 
-void ResponseCurveComponent::paint (juce::Graphics& g)
-{
+void ResponseCurveComponent::updateResponseCurve() {
 	using namespace juce;
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll (Colours::black);
-    
-    g.drawImage(background, getLocalBounds().toFloat());
-    
+	
 	auto responseArea = getAnalysisArea();
     
     auto w = responseArea.getWidth();
     
-    auto &lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto &peak = monoChain.get<ChainPositions::Peak>();
-    auto &highcut = monoChain.get<ChainPositions::HighCut>();
-    
-    auto sampleRate = audioProcessor.getSampleRate();
-    
-    std::vector<double> mags;
+    // the rate chainCoefficients were designed for, so the curve always matches them
+    auto sampleRate = chainSampleRate;
     
+    // keeps its capacity, so only a wider component allocates
     mags.resize(w);
     
     for (int i = 0; i < w; ++i) {
-		double mag = 1.f;
 		auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
 		
-		if (! monoChain.isBypassed<ChainPositions::Peak>())
-			mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-		
-		if (! monoChain.isBypassed<ChainPositions::LowCut>()) {
-			if (! lowcut.isBypassed<0>())
-				mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-			if (! lowcut.isBypassed<1>())
-				mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-			if (! lowcut.isBypassed<2>())
-				mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-			if (! lowcut.isBypassed<3>())
-				mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-		}
-			
-		if (! monoChain.isBypassed<ChainPositions::HighCut>()) {
-			if (! highcut.isBypassed<0>())
-				mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-			if (! highcut.isBypassed<1>())
-				mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-			if (! highcut.isBypassed<2>())
-				mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-			if (! highcut.isBypassed<3>())
-				mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-		}
+		// the bypassed bands are left out
+		auto mag = getMagnitudeForFrequency(chainCoefficients, freq, sampleRate);
 			
 		mags[i] = Decibels::gainToDecibels(mag);
 	}
 	
-	Path responseCurve;
+	responseCurve.clear();
+	responseCurveValid = true;
+	
+	if (mags.empty())
+		return;
 	
 	const double outputMin = responseArea.getBottom();
 	const double outputMax = responseArea.getY();
@@ -371,16 +508,31 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
 	for (size_t i = 1; i < mags.size(); ++i) {
 		responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
 	}
+}
+
+void ResponseCurveComponent::paint (juce::Graphics& g)
+{
+	using namespace juce;
+    // (Our component is opaque, so we must completely fill the background with a solid colour)
+    g.fillAll (Colours::black);
+    
+    g.drawImage(background, getLocalBounds().toFloat());
+    
+	auto responseArea = getAnalysisArea();
+    
+	// the curve only changes with the chain or the size, frames where just the analyzer moved reuse it
+	if (! responseCurveValid)
+		updateResponseCurve();
 	
 	if (shouldShowFFTAnalysis) {
-		auto leftChannelFFTPath = leftPathProducer.getPath();
+		auto leftChannelFFTPath = pathProducer.getPath(Channel::Left);
 		leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY() - 8));
 	
 		// set FFT left color
 		g.setColour(Colours::skyblue);
 		g.strokePath(leftChannelFFTPath, PathStrokeType(1.f));
 	
-		auto rightChannelFFTPath = rightPathProducer.getPath();
+		auto rightChannelFFTPath = pathProducer.getPath(Channel::Right);
 		rightChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY() - 8));
 	
 		// set FFT right color
@@ -400,6 +552,8 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
 void ResponseCurveComponent::resized() {
 	using namespace juce;
 	
+	responseCurveValid = false;
+	
 	background = Image(Image::PixelFormat::RGB, getWidth(), getHeight(), true);
 	Graphics g(background);
 	
@@ -528,6 +682,72 @@ juce::Rectangle<int> ResponseCurveComponent::getAnalysisArea() {
 	return bounds;
 }
 
+CpuLoadOverlay::CpuLoadOverlay(SimpleEQAudioProcessor& p, const ResponseCurveComponent& rcc) : audioProcessor(p), responseCurve(rcc) {
+	setInterceptsMouseClicks(false, false);
+	
+	startTimerHz(4);
+}
+
+void CpuLoadOverlay::timerCallback() {
+	snapshot = audioProcessor.getCpuLoadMeter().getSnapshot();
+	
+	const auto time = juce::Time::getHighResolutionTicks();
+	const auto numFFTs = responseCurve.getNumAnalyzerFFTs();
+	const auto analyzerTicks = responseCurve.getAnalyzerTicks();
+	
+	if (lastTime > 0 && time > lastTime) {
+		const auto elapsed = juce::Time::highResolutionTicksToSeconds(time - lastTime);
+		
+		fftsPerSecond = float((numFFTs - lastNumFFTs) / elapsed);
+		analyzerLoad = float(100.0 * juce::Time::highResolutionTicksToSeconds(analyzerTicks - lastAnalyzerTicks) / elapsed);
+	}
+	
+	lastTime = time;
+	lastNumFFTs = numFFTs;
+	lastAnalyzerTicks = analyzerTicks;
+	
+	repaint();
+}
+
+void CpuLoadOverlay::paint(juce::Graphics &g) {
+	using namespace juce;
+	
+	auto bounds = getLocalBounds().toFloat();
+	auto histogramArea = bounds.removeFromRight(bounds.getHeight() * 3.f).reduced(1.f);
+	
+	g.setColour(Colours::white);
+	g.setFont(10);
+	
+	String text;
+	text << "CPU " << String(snapshot.averageLoad, 1) << "% avg " << String(snapshot.peakLoad, 1) << "% pk "
+		 << String(roundToInt(snapshot.coefficientShare)) << "% coef " << snapshot.totalOverruns << " xrun";
+	
+	String analyzerText;
+	analyzerText << "analyzer " << roundToInt(fftsPerSecond) << " FFT/s " << String(analyzerLoad, 1) << "% core";
+	
+	auto textArea = bounds.toNearestInt().withTrimmedRight(4);
+	g.drawFittedText(text, textArea.removeFromTop(textArea.getHeight() / 2), Justification::bottomRight, 1);
+	g.drawFittedText(analyzerText, textArea, Justification::topRight, 1);
+	
+	g.setColour(Colours::dimgrey);
+	g.drawRect(histogramArea.expanded(1.f));
+	
+	const auto largestBin = *std::max_element(snapshot.histogram.begin(), snapshot.histogram.end());
+	
+	if (largestBin == 0)
+		return;
+	
+	// the overrun bin is drawn red, on the right
+	const auto binWidth = histogramArea.getWidth() / (float) CpuLoadMeter::numBins;
+	
+	for (int bin = 0; bin < CpuLoadMeter::numBins; ++bin) {
+		const auto height = histogramArea.getHeight() * (float) snapshot.histogram[(size_t) bin] / (float) largestBin;
+		
+		g.setColour(bin == CpuLoadMeter::numBins - 1 ? Colours::red : Colours::skyblue);
+		g.fillRect(histogramArea.getX() + bin * binWidth, histogramArea.getBottom() - height, binWidth, height);
+	}
+}
+
 //==============================================================================
 SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p),
@@ -540,6 +760,7 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
     highCutSlopeSlider(*audioProcessor.apvts.getParameter("HighCut Slope"), "dB/Oct"),
     
     responseCurveComponent(audioProcessor),
+    cpuLoadOverlay(audioProcessor, responseCurveComponent),
     peakFreqSliderAttachment(audioProcessor.apvts, "Peak Freq", peakFreqSlider),
     peakGainSliderAttachment(audioProcessor.apvts, "Peak Gain", peakGainSlider),
     peakQualitySliderAttachment(audioProcessor.apvts, "Peak Quality", peakQualitySlider),
@@ -616,6 +837,34 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
 		}
 	};
 	
+	// the ids are the FFT orders
+	analyzerOrderBox.addItemList({ "2048", "4096", "8192" }, SimpleEQAudioProcessor::minAnalyzerFFTOrder);
+	
+	analyzerOrderBox.onChange = [safePtr]() {
+		if (auto *comp = safePtr.getComponent())
+			comp->audioProcessor.setAnalyzerFFTOrder(comp->analyzerOrderBox.getSelectedId());
+	};
+	
+	// the ids are the overlap factors
+	for (auto overlap = 1; overlap <= SimpleEQAudioProcessor::maxAnalyzerOverlap; overlap *= 2)
+		analyzerOverlapBox.addItem(juce::String(overlap) + "x overlap", overlap);
+	
+	analyzerOverlapBox.onChange = [safePtr]() {
+		if (auto *comp = safePtr.getComponent())
+			comp->audioProcessor.setAnalyzerOverlap(comp->analyzerOverlapBox.getSelectedId());
+	};
+	
+	// the ids are the AnalyzerMode values plus one
+	analyzerModeBox.addItemList({ "instant", "average", "peak hold" }, 1);
+	
+	analyzerModeBox.onChange = [safePtr]() {
+		if (auto *comp = safePtr.getComponent())
+			comp->audioProcessor.setAnalyzerMode(comp->analyzerModeBox.getSelectedId() - 1);
+	};
+	
+	updateAnalyzerBoxes();
+	audioProcessor.apvts.state.addListener(this);
+	
 	analyzerEnabledButton.onClick = [safePtr]() {
 		if (auto *comp = safePtr.getComponent()) {
 			auto enabled = comp->analyzerEnabledButton.getToggleState();
@@ -628,12 +877,36 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
 }
 
 SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor() {
+	audioProcessor.apvts.state.removeListener(this);
+	
 	lowCutBypassButton.setLookAndFeel(nullptr);
 	peakBypassButton.setLookAndFeel(nullptr);
 	highCutBypassButton.setLookAndFeel(nullptr);
 	analyzerEnabledButton.setLookAndFeel(nullptr);
 }
 
+void SimpleEQAudioProcessorEditor::updateAnalyzerBoxes() {
+	analyzerOrderBox.setSelectedId(audioProcessor.getAnalyzerFFTOrder(), juce::dontSendNotification);
+	analyzerOverlapBox.setSelectedId(audioProcessor.getAnalyzerOverlap(), juce::dontSendNotification);
+	analyzerModeBox.setSelectedId(audioProcessor.getAnalyzerMode() + 1, juce::dontSendNotification);
+}
+
+/* the host may load a state on any thread, so the boxes only get told to catch up from here */
+void SimpleEQAudioProcessorEditor::valueTreePropertyChanged(juce::ValueTree &tree, const juce::Identifier &) {
+	// the parameters' own changes land on the child trees, the attachments deal with those
+	if (tree == audioProcessor.apvts.state)
+		triggerAsyncUpdate();
+}
+
+void SimpleEQAudioProcessorEditor::valueTreeRedirected(juce::ValueTree &) {
+	// setStateInformation() swaps in a whole new tree
+	triggerAsyncUpdate();
+}
+
+void SimpleEQAudioProcessorEditor::handleAsyncUpdate() {
+	updateAnalyzerBoxes();
+}
+
 //==============================================================================
 void SimpleEQAudioProcessorEditor::paint (juce::Graphics& g)
 {
@@ -656,6 +929,15 @@ void SimpleEQAudioProcessorEditor::resized()
     
     analyzerEnabledButton.setBounds(analyzerEnabledArea);
     
+    auto analyzerSettingsArea = analyzerEnabledArea.withLeft(analyzerEnabledArea.getRight() + 10).withRight(getWidth() - 5);
+    analyzerOrderBox.setBounds(analyzerSettingsArea.removeFromLeft(70));
+    analyzerSettingsArea.removeFromLeft(5);
+    analyzerOverlapBox.setBounds(analyzerSettingsArea.removeFromLeft(80));
+    analyzerSettingsArea.removeFromLeft(5);
+    analyzerModeBox.setBounds(analyzerSettingsArea.removeFromLeft(80));
+    
+    cpuLoadOverlay.setBounds(analyzerSettingsArea.withTrimmedLeft(10));
+    
     bounds.removeFromTop(5);
     
     float hRatio = 25.f / 100.f; //JUCE_LIVE_CONSTANT(33) / 100.f;
@@ -684,6 +966,6 @@ void SimpleEQAudioProcessorEditor::resized()
 
 std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps() {
 	return {
-		&peakFreqSlider, &peakGainSlider, &peakQualitySlider, &lowCutFreqSlider, &highCutFreqSlider, &lowCutSlopeSlider, &highCutSlopeSlider, &responseCurveComponent, &lowCutBypassButton, &peakBypassButton, &highCutBypassButton, &analyzerEnabledButton
+		&peakFreqSlider, &peakGainSlider, &peakQualitySlider, &lowCutFreqSlider, &highCutFreqSlider, &lowCutSlopeSlider, &highCutSlopeSlider, &responseCurveComponent, &lowCutBypassButton, &peakBypassButton, &highCutBypassButton, &analyzerEnabledButton, &cpuLoadOverlay, &analyzerOrderBox, &analyzerOverlapBox, &analyzerModeBox
 	};
 }
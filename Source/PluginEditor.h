@@ -18,6 +18,13 @@ enum FFTOrder
     order8192 = 13
 };
 
+enum AnalyzerMode
+{
+    Instant,
+    Average,
+    PeakHold
+};
+
 // explanation in ppm for musicians courses
 template<typename BlockType>
 struct FFTDataGenerator
@@ -27,43 +34,119 @@ struct FFTDataGenerator
      */
     void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData, const float negativeInfinity)
     {
-        const auto fftSize = getFFTSize();
+        produceFFTDataForRendering(audioData.getReadPointer(0), getFFTSize(), nullptr, 0, negativeInfinity);
+    }
+    
+    /**
+     the same from a window in two pieces, e.g. a circular buffer read from its oldest sample on.
+     the sizes have to add up to the FFT size.
+     */
+    void produceFFTDataForRendering(const float* first, int firstSize, const float* second, int secondSize, const float negativeInfinity)
+    {
+        jassert(firstSize + secondSize == getFFTSize());
         
-        fftData.assign(fftData.size(), 0);
-        auto* readIndex = audioData.getReadPointer(0);
-        std::copy(readIndex, readIndex + fftSize, fftData.begin());
+        // straight into the fifo's next slot. when the consumer has fallen behind, this frame is skipped
+        fftDataFifo.write([&](BlockType& fftData)
+        {
+            const auto fftSize = getFFTSize();
         
-        // first apply a windowing function to our data
-        window->multiplyWithWindowingTable (fftData.data(), fftSize);       // [1]
+            // only the first half is input, the transform doesn't read the rest before writing it
+            std::copy(first, first + firstSize, fftData.begin());
+            std::copy(second, second + secondSize, fftData.begin() + firstSize);
         
-        // then render our FFT data..
-        forwardFFT->performFrequencyOnlyForwardTransform (fftData.data());  // [2]
+            // first apply a windowing function to our data
+            window->multiplyWithWindowingTable (fftData.data(), fftSize);       // [1]
         
-        int numBins = (int)fftSize / 2;
+            // then render our FFT data.. only the bins up to nyquist get drawn
+            forwardFFT->performFrequencyOnlyForwardTransform (fftData.data(), true);  // [2]
         
-        //normalize the fft values.
-        for( int i = 0; i < numBins; ++i )
+            int numBins = (int)fftSize / 2;
+        
+            //normalize the fft values and convert them to decibels
+            magnitudesToDecibels(fftData.data(), numBins, float(numBins), negativeInfinity);
+        });
+    }
+    
+    /**
+     both channels of a stereo pair from one complex FFT, the left window goes in as the real part and the right one
+     as the imaginary part. the spectra are separated again using the symmetry of a real signal's spectrum,
+     so this costs about as much as one channel. left and right are circular windows of the FFT size,
+     read from oldestSample round. the frame holds the left bins first, then the right ones.
+     */
+    void produceStereoFFTDataForRendering(const float* left, const float* right, int oldestSample, const float negativeInfinity)
+    {
+        fftDataFifo.write([&](BlockType& fftData)
         {
-            auto v = fftData[i];
-//            fftData[i] /= (float) numBins;
-            if( !std::isinf(v) && !std::isnan(v) )
+            const auto fftSize = getFFTSize();
+            const auto numBins = fftSize / 2;
+            const auto numNewest = fftSize - oldestSample;
+            
+            // the frame's two halves hold the windowed channels until they're packed
+            auto* leftWindow = fftData.data();
+            auto* rightWindow = fftData.data() + fftSize;
+            
+            for (auto [windowed, channel] : { std::pair { leftWindow, left }, std::pair { rightWindow, right } })
             {
-                v /= float(numBins);
+                std::copy(channel + oldestSample, channel + fftSize, windowed);
+                std::copy(channel, channel + oldestSample, windowed + numNewest);
+                window->multiplyWithWindowingTable (windowed, fftSize);
             }
-            else
+            
+            for (int i = 0; i < fftSize; ++i)
+                stereoInput[(size_t) i] = { leftWindow[i], rightWindow[i] };
+            
+            forwardFFT->perform (stereoInput.data(), stereoOutput.data(), false);
+            
+            // L[k] = (Z[k] + conj(Z[N - k])) / 2 and R[k] = (Z[k] - conj(Z[N - k])) / 2i, only their magnitudes are needed
+            for (int k = 0; k < numBins; ++k)
             {
-                v = 0.f;
+                const auto z = stereoOutput[(size_t) k];
+                const auto mirrored = std::conj(stereoOutput[(size_t) ((fftSize - k) & (fftSize - 1))]);
+                
+                fftData[(size_t) k] = 0.5f * std::abs(z + mirrored);
+                fftData[(size_t) (numBins + k)] = 0.5f * std::abs(z - mirrored);
             }
-            fftData[i] = v;
-        }
+            
+            //normalize the fft values and convert them to decibels
+            magnitudesToDecibels(fftData.data(), fftSize, float(numBins), negativeInfinity);
+        });
+    }
+    
+    /**
+     normalises the magnitudes and converts them to decibels in one branch free pass, which the compiler vectorises.
+     NaN, inf, zero and denormal magnitudes come out as negativeInfinity, like gainToDecibels() does for silence.
+     log2 is the exponent plus 4 terms of the atanh series on the mantissa, which keeps it within 0.0002 dB of log10.
+     */
+    static void magnitudesToDecibels(float* data, int numBins, float normalisation, float negativeInfinity)
+    {
+        // 20 * log10(v / normalisation) is 20 * log10(2) * log2(v) - 20 * log10(normalisation)
+        constexpr auto decibelsPerOctave = 6.020599913f;
+        const auto offset = 20.f * std::log10(normalisation);
         
-        //convert them to decibels
         for( int i = 0; i < numBins; ++i )
         {
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
+            juce::uint32 bits;
+            std::memcpy(&bits, data + i, sizeof(float));
+            
+            // v = 2^exponent * mantissa, with the mantissa in [1, 2)
+            const auto exponent = int((bits >> 23) & 0xff);
+            const juce::uint32 mantissaBits = (bits & 0x007fffff) | 0x3f800000;
+            
+            float mantissa;
+            std::memcpy(&mantissa, &mantissaBits, sizeof(float));
+            
+            // log2(m) = 2 / ln(2) * atanh((m - 1) / (m + 1)), t stays below 1/3 so the series converges quickly
+            const auto t = (mantissa - 1.f) / (mantissa + 1.f);
+            const auto t2 = t * t;
+            const auto log2Mantissa = t * (2.885390082f + t2 * (0.961796694f + t2 * (0.577078016f + t2 * 0.412198583f)));
+            
+            const auto decibels = decibelsPerOctave * (float(exponent - 127) + log2Mantissa) - offset;
+            
+            // exponent 0 is zero or denormal, 255 is inf or NaN. written as selects so the loop stays vectorisable
+            const auto isNormal = (unsigned) (exponent - 1) < 254u;
+            const auto clamped = decibels > negativeInfinity ? decibels : negativeInfinity;
+            data[i] = isNormal ? clamped : negativeInfinity;
         }
-        
-        fftDataFifo.push(fftData);
     }
     
     void changeOrder(FFTOrder newOrder)
@@ -78,33 +161,50 @@ struct FFTDataGenerator
         forwardFFT = std::make_unique<juce::dsp::FFT>(order);
         window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
         
-        fftData.clear();
-        fftData.resize(fftSize * 2, 0);
-
-        fftDataFifo.prepare(fftData.size());
+        fftDataFifo.prepare((size_t) fftSize * 2);
+        
+        stereoInput.resize((size_t) fftSize);
+        stereoOutput.resize((size_t) fftSize);
     }
     //==============================================================================
     int getFFTSize() const { return 1 << order; }
     int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
     //==============================================================================
     bool getFFTData(BlockType& fftData) { return fftDataFifo.pull(fftData); }
+    
+    /** use(const BlockType&) reads the oldest FFT frame where it is, without copying it out */
+    template<typename Use>
+    bool readFFTData(Use&& use) { return fftDataFifo.read([&use](const BlockType& fftData) { use(fftData); }); }
 private:
     FFTOrder order;
-    BlockType fftData;
     std::unique_ptr<juce::dsp::FFT> forwardFFT;
     std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
     
-    Fifo<BlockType> fftDataFifo;
+    // the packed stereo pair, in and out of the complex FFT
+    std::vector<juce::dsp::Complex<float>> stereoInput, stereoOutput;
+    
+    // the frames are read as soon as they're made, so a few of them is plenty
+    Fifo<BlockType, 4> fftDataFifo;
 };
 
 // explanation in ppm for musicians courses
 template<typename PathType>
 struct AnalyzerPathGenerator
 {
+    void generatePath(const std::vector<float>& renderData,
+                      juce::Rectangle<float> fftBounds,
+                      int fftSize,
+                      float binWidth,
+                      float negativeInfinity)
+    {
+        generatePath(renderData.data(), fftBounds, fftSize, binWidth, negativeInfinity);
+    }
+    
     /*
      converts 'renderData[]' into a juce::Path
+     with at most one min/max pair per pixel column, however many bins there are
      */
-    void generatePath(const std::vector<float>& renderData,
+    void generatePath(const float* renderData,
                       juce::Rectangle<float> fftBounds,
                       int fftSize,
                       float binWidth,
@@ -114,44 +214,43 @@ struct AnalyzerPathGenerator
         auto bottom = fftBounds.getHeight();
         auto width = fftBounds.getWidth();
 
-        int numBins = (int)fftSize / 2;
-
-        PathType p;
-        p.preallocateSpace(3 * (int)fftBounds.getWidth());
+        // only changes with the FFT size, the sample rate or the width
+        if (fftSize != columnMapFFTSize || binWidth != columnMapBinWidth || width != columnMapWidth)
+            buildColumnMap(fftSize, binWidth, width);
 
-        auto map = [bottom, top, negativeInfinity](float v)
+        // built in the fifo's next slot, which still has the storage of the path that was last swapped out of it
+        pathFifo.write([&](PathType& p)
         {
-            return juce::jmap(v,
-                              negativeInfinity, 0.f,
-                              float(bottom+10),   top);
-        };
-
-        auto y = map(renderData[0]);
+            p.clear();
+            p.preallocateSpace(3 * (2 * (int)columns.size() + 1));
 
-//        jassert( !std::isnan(y) && !std::isinf(y) );
-        if( std::isnan(y) || std::isinf(y) )
-            y = bottom;
-        
-        p.startNewSubPath(0, y);
-
-        const int pathResolution = 2; //you can draw line-to's every 'pathResolution' pixels.
+            auto map = [bottom, top, negativeInfinity](float v)
+            {
+                return juce::jmap(v,
+                                  negativeInfinity, 0.f,
+                                  float(bottom+10),   top);
+            };
 
-        for( int binNum = 1; binNum < numBins; binNum += pathResolution )
-        {
-            y = map(renderData[binNum]);
+            auto y = map(renderData[0]);
 
-//            jassert( !std::isnan(y) && !std::isinf(y) );
+//        jassert( !std::isnan(y) && !std::isinf(y) );
+            if( std::isnan(y) || std::isinf(y) )
+                y = bottom;
+            
+            p.startNewSubPath(0, y);
 
-            if( !std::isnan(y) && !std::isinf(y) )
+            for( const auto& column : columns )
             {
-                auto binFreq = binNum * binWidth;
-                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-                int binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX, y);
+                auto first = renderData + column.firstBin;
+                auto [lowest, highest] = std::minmax_element(first, first + column.numBins);
+                
+                // FFTDataGenerator never hands out NaN or inf, it floors them at negativeInfinity
+                p.lineTo(column.x, map(*highest));
+                
+                if( column.numBins > 1 )
+                    p.lineTo(column.x, map(*lowest));
             }
-        }
-
-        pathFifo.push(p);
+        });
     }
 
     int getNumPathsAvailable() const
@@ -159,12 +258,45 @@ struct AnalyzerPathGenerator
         return pathFifo.getNumAvailableForReading();
     }
 
+    /** swaps the oldest path into 'path', whose old storage goes back to the fifo */
     bool getPath(PathType& path)
     {
-        return pathFifo.pull(path);
+        return pathFifo.swapOut(path);
     }
 private:
-    Fifo<PathType> pathFifo;
+    Fifo<PathType, 4> pathFifo;
+    
+    // the run of bins that lands on each pixel column, in order. only columns that have a bin are in here
+    struct Column
+    {
+        float x;
+        int firstBin, numBins;
+    };
+    
+    std::vector<Column> columns;
+    int columnMapFFTSize = 0;
+    float columnMapBinWidth = 0, columnMapWidth = 0;
+    
+    void buildColumnMap(int fftSize, float binWidth, float width)
+    {
+        columnMapFFTSize = fftSize;
+        columnMapBinWidth = binWidth;
+        columnMapWidth = width;
+        
+        columns.clear();
+        
+        for( int binNum = 1; binNum < fftSize / 2; ++binNum )
+        {
+            auto binFreq = binNum * binWidth;
+            auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
+            auto binX = std::floor(normalizedBinX * width);
+            
+            if( ! columns.empty() && columns.back().x == binX )
+                ++columns.back().numBins;
+            else
+                columns.push_back({ binX, binNum, 1 });
+        }
+    }
 };
 
 struct LookAndFeel : juce::LookAndFeel_V4 {
@@ -202,34 +334,107 @@ private:
 	juce::String suffix;
 };
 
+/* runs on the AnalyzerThread. the editor sets the area to draw into and picks up the latest finished paths,
+ * the FFTs and path building never touch the message thread.
+ * both taps are analysed together, with one complex FFT for the pair */
 struct PathProducer {
-	PathProducer(SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType> &scsf) :
-	leftChannelFifo(&scsf) {
-		leftChannelFFTDataGenerator.changeOrder(FFTOrder::order2048);
-		monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+	PathProducer(SingleChannelSampleFifo &left, SingleChannelSampleFifo &right) {
+		channels[Channel::Left].fifo = &left;
+		channels[Channel::Right].fifo = &right;
+		
+		changeOrder(FFTOrder::order2048);
 	}
-	void process(juce::Rectangle<float> fftbounds, double sampleRate);
-	juce::Path getPath() { return leftChannelFFTPath; }
+	
+	/** message thread. nothing is analysed until there's an area and a sample rate */
+	void setAnalysisArea(juce::Rectangle<float> fftBounds, double sampleRate);
+	
+	/** message thread. the analyzer thread switches over before its next FFT */
+	void setAnalysisSettings(FFTOrder order, int overlap, AnalyzerMode mode);
+	
+	/** analyzer thread */
+	void process();
+	
+	/** message thread. true if newer paths were finished since the last call, getPath() returns them from then on.
+	    every call asks for one more pair, so paths are only built as often as they're picked up */
+	bool pullLatestPaths() {
+		pathsWanted = true;
+		
+		auto left = channels[Channel::Left].paths.acquire();
+		auto right = channels[Channel::Right].paths.acquire();
+		
+		return left || right;
+	}
+	const juce::Path &getPath(Channel channel) const { return channels[channel].paths.getReadBuffer(); }
+	
+	/** running totals, any thread. the difference between two readings is the analyzer's cost in between.
+	    a stereo pair is one FFT */
+	juce::int64 getNumFFTs() const { return numFFTs.load(); }
+	juce::int64 getAnalysisTicks() const { return analysisTicks.load(); }
 	
 private:
-	SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType> *leftChannelFifo;
+	juce::CriticalSection areaLock;
+	juce::Rectangle<float> analysisArea;
+	double analysisSampleRate = 0;
+	FFTOrder analysisOrder = FFTOrder::order2048;
+	int analysisOverlap = 4;
+	AnalyzerMode analysisMode = AnalyzerMode::Instant;
+	
+	std::atomic<juce::int64> numFFTs { 0 }, analysisTicks { 0 };
+	
+	void changeOrder(FFTOrder);
+	
+	struct ChannelAnalysis {
+		SingleChannelSampleFifo *fifo = nullptr;
+		
+		// circular, the next hop overwrites the oldest samples from writePosition on
+		juce::AudioBuffer<float> monoBuffer;
+		
+		AnalyzerPathGenerator<juce::Path> pathGenerator;
+		
+		// the analyzer thread builds into the write side, the message thread paints the read side
+		TripleBuffer<juce::Path> paths;
+	};
+	
+	// indexed by Channel
+	std::array<ChannelAnalysis, 2> channels;
+	int writePosition = 0;
 	
-	juce::AudioBuffer<float> monoBuffer;
+	FFTDataGenerator<std::vector<float>> fftDataGenerator;
 	
-	FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
+	// every FFT frame is folded into this, in dB, the left bins then the right ones.
+	// paths are only made from it when the editor wants them
+	std::vector<float> spectrum;
+	AnalyzerMode spectrumMode = AnalyzerMode::Instant;
+	bool spectrumChanged = false;
+	std::atomic<bool> pathsWanted { true };
 	
-	AnalyzerPathGenerator<juce::Path> pathProducer;
+	// how long the average takes to settle, and how fast a held peak falls back
+	static constexpr double averagingTimeSeconds = 0.25, peakDecayDecibelsPerSecond = 12.0;
 	
-	juce::Path leftChannelFFTPath;
+	void accumulate(const std::vector<float> &fftData, AnalyzerMode, double frameSeconds);
 };
 
-struct ResponseCurveComponent : juce::Component, juce::AudioProcessorParameter::Listener, juce::Timer {
-	ResponseCurveComponent(SimpleEQAudioProcessor&);
-	~ResponseCurveComponent();
+/* one background thread runs the analyzers of every open editor */
+struct AnalyzerThread : juce::Thread {
+	AnalyzerThread();
+	~AnalyzerThread() override;
 	
-	void parameterValueChanged (int parameterIndex, float newValue) override;
+	void add(PathProducer *);
+	void remove(PathProducer *);
+	
+	void run() override;
+	
+private:
+	// a bit faster than the editors repaint, so there's always a fresh frame
+	static constexpr int analysisIntervalMs = 10;
+	
+	juce::CriticalSection lock;
+	juce::Array<PathProducer*> producers;
+};
 
-	void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override { }
+struct ResponseCurveComponent : juce::Component, juce::Timer {
+	ResponseCurveComponent(SimpleEQAudioProcessor&);
+	~ResponseCurveComponent() override;
 	
 	void timerCallback() override;
 	
@@ -237,18 +442,31 @@ struct ResponseCurveComponent : juce::Component, juce::AudioProcessorParameter::
 	
 	void resized() override;
 	
-	void toggleAnalysisEnablement(bool enabled) {
-		shouldShowFFTAnalysis = enabled;
-	}
+	void toggleAnalysisEnablement(bool enabled);
+	
+	/** the analyzer's totals, see PathProducer::getNumFFTs() */
+	juce::int64 getNumAnalyzerFFTs() const { return pathProducer.getNumFFTs(); }
+	juce::int64 getAnalyzerTicks() const { return pathProducer.getAnalysisTicks(); }
 	
 private:
 	SimpleEQAudioProcessor& audioProcessor;
 	
-	juce::Atomic<bool> parametersChanged { false };
+	// the band generations, sample rate and cut table chainCoefficients were last designed for
+	ChainParameters::Generations chainGenerations {};
+	double chainSampleRate = 0;
+	std::shared_ptr<const CutCoefficientTable> chainCutTable;
+	
+	// designed the way the processor designs its own, so the curve shows the sections that actually run
+	ChainCoefficients chainCoefficients;
+	
+	void updateChain(const ChainParameters::Generations &);
 	
-	MonoChain monoChain;
+	// the chain's response in dB per pixel column and its path, rebuilt by paint once updateChain or resized invalidate them
+	std::vector<double> mags;
+	juce::Path responseCurve;
+	bool responseCurveValid = false;
 	
-	void updateChain();
+	void updateResponseCurve();
 	
 	juce::Image background;
 	
@@ -256,11 +474,33 @@ private:
 	
 	juce::Rectangle<int> getAnalysisArea();
 	
-	PathProducer leftPathProducer, rightPathProducer;
+	PathProducer pathProducer;
+	
+	juce::SharedResourcePointer<AnalyzerThread> analyzerThread;
 	
 	bool shouldShowFFTAnalysis = true;
 };
 
+/* the audio thread's recent load, as a histogram over the block deadline plus the average, peak and overrun count.
+ * underneath, what the analyzer thread spends on this editor */
+struct CpuLoadOverlay : juce::Component, juce::Timer {
+	CpuLoadOverlay(SimpleEQAudioProcessor&, const ResponseCurveComponent&);
+	
+	void timerCallback() override;
+	
+	void paint(juce::Graphics &g) override;
+	
+private:
+	SimpleEQAudioProcessor& audioProcessor;
+	const ResponseCurveComponent& responseCurve;
+	
+	CpuLoadMeter::Snapshot snapshot;
+	
+	// the analyzer's totals at the last timer callback, and its rates since
+	juce::int64 lastTime = 0, lastNumFFTs = 0, lastAnalyzerTicks = 0;
+	float fftsPerSecond = 0, analyzerLoad = 0;
+};
+
 //==============================================================================
 struct PowerButton : juce::ToggleButton { };
 struct AnalyzerButton : juce::ToggleButton {
@@ -282,7 +522,9 @@ struct AnalyzerButton : juce::ToggleButton {
 };
 /**
 */
-class SimpleEQAudioProcessorEditor  : public juce::AudioProcessorEditor
+class SimpleEQAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                      private juce::ValueTree::Listener,
+                                      private juce::AsyncUpdater
 {
 public:
     SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor&);
@@ -300,6 +542,17 @@ private:
     RotarySliderWithLabels peakFreqSlider, peakGainSlider, peakQualitySlider, lowCutFreqSlider, highCutFreqSlider, lowCutSlopeSlider, highCutSlopeSlider;
     
     ResponseCurveComponent responseCurveComponent;
+    CpuLoadOverlay cpuLoadOverlay;
+    
+    // the analyzer's FFT size, overlap and mode, stored with the processor's state.
+    // they're kept in step with it, so loading a preset shows up here too
+    juce::ComboBox analyzerOrderBox, analyzerOverlapBox, analyzerModeBox;
+    
+    void updateAnalyzerBoxes();
+    
+    void valueTreePropertyChanged(juce::ValueTree &, const juce::Identifier &) override;
+    void valueTreeRedirected(juce::ValueTree &) override;
+    void handleAsyncUpdate() override;
     
     using APVTS = juce::AudioProcessorValueTreeState;
     using Attachment = APVTS::SliderAttachment;
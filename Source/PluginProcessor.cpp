@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "RealtimeSafety.h"
 
 //==============================================================================
 SimpleEQAudioProcessor::SimpleEQAudioProcessor()
@@ -22,10 +23,16 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                        )
 #endif
 {
+	designThread->add(this);
+	
+	// the design thread sleeps until something changes
+	chainParameters.onChange = [this] { designThread->notify(); };
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+	chainParameters.onChange = nullptr;
+	designThread->remove(this);
 }
 
 //==============================================================================
@@ -104,10 +111,49 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     
     spec.sampleRate = sampleRate;
     
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
-    
+	// one lane per channel of whatever layout the host picked, in the precision it picked.
+	// the other pool is emptied, hosts can only switch precision before prepareToPlay
+	const auto numChannels = getTotalNumOutputChannels();
+	
+	// linear phase mode runs its FIR at the host rate, in place of the IIR chain and its oversampling
+	linearPhaseMode = usesLinearPhase();
+	
+	const auto oversamplingOrder = linearPhaseMode ? 0 : getOversamplingOrder();
+	auto latency = prepareOversampling(numChannels, samplesPerBlock, oversamplingOrder);
+	
+	{
+		const juce::ScopedLock sl(designLock);
+		linearPhaseFilter.prepare(linearPhaseMode ? numChannels : 0, samplesPerBlock, sampleRate, getLinearPhaseKernelLength());
+		
+		if (linearPhaseMode)
+			latency = linearPhaseFilter.getLatencyInSamples();
+	}
+	
+	setLatencySamples(latency);
+	
+	// the chain sees the oversampled blocks, and is designed for the oversampled rate
+	const auto oversamplingFactor = 1 << oversamplingOrder;
+	processingSampleRate = sampleRate * oversamplingFactor;
+	
+	floatChainPool.prepare(isUsingDoublePrecision() ? 0 : numChannels, samplesPerBlock * oversamplingFactor);
+	doubleChainPool.prepare(isUsingDoublePrecision() ? numChannels : 0, samplesPerBlock * oversamplingFactor);
+	applyChannelLinks();
+	
+	prepareCoefficientTables();
+	
+	// the sample rate may have changed, so every band needs redesigning.
+	// design on this thread so the chain starts out with the right coefficients
+	chainParameters.invalidateAll();
+	auto generations = chainParameters.getGenerations();
+	
 	updateFilters();
+	applyPendingCoefficients();
+	
+	// the ramp starts out from what was just designed
+	coefficientRamp.reset(coefficientSets.getReadBuffer());
+	rampGenerations = generations;
+	
+	cpuLoadMeter.prepare(sampleRate);
 	
 	leftChannelFifo.prepare(samplesPerBlock);
 	rightChannelFifo.prepare(samplesPerBlock);
@@ -132,12 +178,9 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // every channel gets its own lane in the chain pool, so any layout works:
+    // mono, stereo, 5.1, 7.1.4, ambisonics...
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -151,8 +194,25 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 }
 #endif
 
-void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
 {
+	processSamples(buffer);
+}
+
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+	processSamples(buffer);
+}
+
+/* one code path for both precisions, only the chain pool differs */
+template<typename SampleType>
+void SimpleEQAudioProcessor::processSamples(juce::AudioBuffer<SampleType> &buffer)
+{
+	// in checked builds, flags every allocation and lock from here on. offline renders may design in place, so they're exempt
+	RealtimeSafety::ScopedRealtimeSection realtimeSection { ! isNonRealtime() };
+	
+	const auto blockStart = juce::Time::getHighResolutionTicks();
+	
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -166,26 +226,75 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
         
-	updateFilters();
+	// offline renders run faster than the design thread polls, so they design in place
+	if (isNonRealtime())
+		designIfNeeded();
+	
+	applyPendingCoefficients();
+	
+	auto coefficientTicks = juce::Time::getHighResolutionTicks() - blockStart;
         
-	juce::dsp::AudioBlock<float> block(buffer);
+	juce::dsp::AudioBlock<SampleType> block(buffer);
 	
 //	buffer.clear();
 //	
 //	juce::dsp::ProcessContextReplacing<float> stereoContext(block);
 //	osc.process(stereoContext);
 	
-	auto leftBlock = block.getSingleChannelBlock(0);
-	auto rightBlock = block.getSingleChannelBlock(1);
-	
-	juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-	juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+	auto channelBlock = block.getSubsetChannelBlock(0, (size_t) totalNumInputChannels);
 	
-	leftChain.process(leftContext);
-	rightChain.process(rightContext);
+	if (linearPhaseMode)
+		linearPhaseFilter.process(channelBlock);
+	else
+		processChain(channelBlock);
 	
 	leftChannelFifo.update(buffer);
 	rightChannelFifo.update(buffer);
+	
+	coefficientTicks += coefficientRamp.takeDesignTicks();
+	cpuLoadMeter.addBlock(juce::Time::getHighResolutionTicks() - blockStart, coefficientTicks, buffer.getNumSamples());
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processChain(const juce::dsp::AudioBlock<SampleType> &block) {
+	auto &oversampling = getOversampling<SampleType>();
+	
+	// the chain pool splits oversized blocks itself
+	if (oversampling == nullptr) {
+		processChainAtProcessingRate(block, 1);
+		return;
+	}
+	
+	// but the oversampling stage only has room for the block size it was prepared with, and hosts may send more
+	const auto numSamples = block.getNumSamples();
+	const auto oversamplingFactor = (int) oversampling->getOversamplingFactor();
+	
+	for (size_t start = 0; start < numSamples; start += oversamplingBlockSize) {
+		auto subBlock = block.getSubBlock(start, juce::jmin(oversamplingBlockSize, numSamples - start));
+		
+		processChainAtProcessingRate(oversampling->processSamplesUp(subBlock), oversamplingFactor);
+		oversampling->processSamplesDown(subBlock);
+	}
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processChainAtProcessingRate(const juce::dsp::AudioBlock<SampleType> &chainBlock, int oversamplingFactor) {
+	auto &chainPool = getChainPool<SampleType>();
+	
+	// the ramp's sub-blocks cover the same time at any oversampling factor
+	auto subBlockSize = rampSubBlockSize.load() * oversamplingFactor;
+	
+	// all channels run through the cascade together, one per SIMD lane.
+	// while ramping the audio thread designs the moving bands itself, the design thread stays out of it.
+	// the table can only change with the callback lock held, see prepareCoefficientTables()
+	auto generations = chainParameters.getGenerations();
+	
+	if (subBlockSize > 0 && generations != rampGenerations) {
+		rampGenerations = generations;
+		coefficientRamp.process(chainPool, chainBlock, chainParameters.getSettings(), getProcessingSampleRate(), subBlockSize, cutTable.get());
+	} else {
+		chainPool.process(chainBlock);
+	}
 }
 
 //==============================================================================
@@ -201,6 +310,17 @@ juce::AudioProcessorEditor* SimpleEQAudioProcessor::createEditor()
 }
 
 //==============================================================================
+// settings that aren't parameters live as properties on the state tree
+static const juce::Identifier coefficientTablesProperty { "CoefficientTables" };
+static const juce::Identifier coefficientRampSubBlockSizeProperty { "CoefficientRampSubBlockSize" };
+static const juce::Identifier oversamplingOrderProperty { "OversamplingOrder" };
+static const juce::Identifier linearPhaseProperty { "LinearPhase" };
+static const juce::Identifier linearPhaseKernelLengthProperty { "LinearPhaseKernelLength" };
+static const juce::Identifier analyzerFFTOrderProperty { "AnalyzerFFTOrder" };
+static const juce::Identifier analyzerOverlapProperty { "AnalyzerOverlap" };
+static const juce::Identifier analyzerModeProperty { "AnalyzerMode" };
+static const juce::Identifier unlinkedChannelsProperty { "UnlinkedChannels" };
+
 void SimpleEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
     // You should use this method to store your parameters in the memory block.
@@ -219,81 +339,506 @@ void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBy
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     
     if (tree.isValid()) {
+		// these need the processing rebuilt
+		auto oversamplingOrder = getOversamplingOrder();
+		auto linearPhase = usesLinearPhase();
+		auto kernelLength = getLinearPhaseKernelLength();
+		auto unlinkedChannels = getUnlinkedChannels();
+		
 		apvts.replaceState(tree);
-		updateFilters();
+		rampSubBlockSize = (int) apvts.state.getProperty(coefficientRampSubBlockSizeProperty, 0);
+		
+		if (getOversamplingOrder() != oversamplingOrder || usesLinearPhase() != linearPhase || getLinearPhaseKernelLength() != kernelLength
+			|| getUnlinkedChannels() != unlinkedChannels) {
+			restartProcessing();
+		} else {
+			prepareCoefficientTables();
+			designIfNeeded();
+		}
 	}
 }
 
-ChainSettings getChainSettings (juce::AudioProcessorValueTreeState &apvts) {
+ChainParameters::ChainParameters(juce::AudioProcessorValueTreeState &apvts) {
+	auto getFloat = [&apvts](const juce::String &id) { return dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(id)); };
+	auto getChoice = [&apvts](const juce::String &id) { return dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(id)); };
+	auto getBool = [&apvts](const juce::String &id) { return dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter(id)); };
+	
+	lowCutFreq = getFloat("LowCut Freq");
+	highCutFreq = getFloat("HighCut Freq");
+	
+	peakFreq = getFloat("Peak Freq");
+	peakGain = getFloat("Peak Gain");
+	peakQuality = getFloat("Peak Quality");
+	
+	lowCutSlope = getChoice("LowCut Slope");
+	highCutSlope = getChoice("HighCut Slope");
+	
+	lowCutBypassed = getBool("LowCut Bypassed");
+	peakBypassed = getBool("Peak Bypassed");
+	highCutBypassed = getBool("HighCut Bypassed");
+	
+	bandForParameterIndex.resize(apvts.processor.getParameters().size(), -1);
+	
+	for (auto &generation : generations)
+		generation = 1;
+	
+	listenTo(lowCutFreq, LowCut);
+	listenTo(lowCutSlope, LowCut);
+	listenTo(lowCutBypassed, LowCut);
+	
+	listenTo(peakFreq, Peak);
+	listenTo(peakGain, Peak);
+	listenTo(peakQuality, Peak);
+	listenTo(peakBypassed, Peak);
+	
+	listenTo(highCutFreq, HighCut);
+	listenTo(highCutSlope, HighCut);
+	listenTo(highCutBypassed, HighCut);
+}
+
+ChainParameters::~ChainParameters() {
+	for (auto *param : listenedParameters)
+		param->removeListener(this);
+}
+
+void ChainParameters::listenTo(juce::AudioProcessorParameter *param, ChainPositions band) {
+	jassert(param != nullptr); // parameter missing or of the wrong type!
+	
+	bandForParameterIndex[(size_t) param->getParameterIndex()] = band;
+	
+	param->addListener(this);
+	listenedParameters.add(param);
+}
+
+ChainSettings ChainParameters::getSettings() const {
 	ChainSettings settings;
 	
-	settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-	settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
+	settings.lowCutFreq = lowCutFreq->get();
+	settings.highCutFreq = highCutFreq->get();
 	
-	settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-	settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-	settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
+	settings.peakFreq = peakFreq->get();
+	settings.peakGainInDecibels = peakGain->get();
+	settings.peakQuality = peakQuality->get();
 	
-	settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-	settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+	settings.lowCutSlope = static_cast<Slope>(lowCutSlope->getIndex());
+	settings.highCutSlope = static_cast<Slope>(highCutSlope->getIndex());
 	
-	settings.lowCutBypassed = apvts.getRawParameterValue("LowCut Bypassed")->load() > 0.5f;
-	settings.peakBypassed = apvts.getRawParameterValue("Peak Bypassed")->load() > 0.5f;
-	settings.highCutBypassed = apvts.getRawParameterValue("HighCut Bypassed")->load() > 0.5f;
+	settings.lowCutBypassed = lowCutBypassed->get();
+	settings.peakBypassed = peakBypassed->get();
+	settings.highCutBypassed = highCutBypassed->get();
 	
 	return settings;
 }
 
-Coefficients makePeakFilter(const ChainSettings &chainSettings, double sampleRate) {
-	return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+void ChainParameters::invalidate(ChainPositions band) {
+	++generations[band];
+	
+	if (onChange != nullptr)
+		onChange();
 }
 
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings) {
-	auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+void ChainParameters::invalidateAll() {
+	for (auto &generation : generations)
+		++generation;
 	
-	leftChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-	rightChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-    
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-	updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+	if (onChange != nullptr)
+		onChange();
 }
 
-void updateCoefficients(Coefficients &old, const Coefficients &replacements) {
-	*old = *replacements;
+void ChainParameters::parameterValueChanged(int parameterIndex, float newValue) {
+	if (juce::isPositiveAndBelow(parameterIndex, (int) bandForParameterIndex.size())) {
+		auto band = bandForParameterIndex[(size_t) parameterIndex];
+		
+		if (band >= 0) {
+			++generations[(size_t) band];
+			
+			if (onChange != nullptr)
+				onChange();
+		}
+	}
 }
 
-void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings &chainSettings) {
-	auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
-    
-    auto &leftLowCut = leftChain.get<ChainPositions::LowCut>();
-	auto &rightLowCut = rightChain.get<ChainPositions::LowCut>();
+void designPeakFilter(const ChainSettings &chainSettings, double sampleRate, BiquadCoefficients &peak) {
+	designPeakFilter(peak, chainSettings.peakFreq, sampleRate, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+}
+
+void designLowCutFilter(const ChainSettings &chainSettings, double sampleRate, CutCoefficients &lowCut) {
+	designButterworthHighPass(lowCut, chainSettings.lowCutFreq, sampleRate, chainSettings.lowCutSlope + 1);
+}
+
+void designHighCutFilter(const ChainSettings &chainSettings, double sampleRate, CutCoefficients &highCut) {
+	designButterworthLowPass(highCut, chainSettings.highCutFreq, sampleRate, chainSettings.highCutSlope + 1);
+}
+
+void designLowCutFilter(const ChainSettings &chainSettings, double sampleRate, const CutCoefficientTable *table, CutCoefficients &lowCut) {
+	if (table != nullptr)
+		table->lookupHighPass(lowCut, chainSettings.lowCutFreq, chainSettings.lowCutSlope + 1);
+	else
+		designLowCutFilter(chainSettings, sampleRate, lowCut);
+}
+
+void designHighCutFilter(const ChainSettings &chainSettings, double sampleRate, const CutCoefficientTable *table, CutCoefficients &highCut) {
+	if (table != nullptr)
+		table->lookupLowPass(highCut, chainSettings.highCutFreq, chainSettings.highCutSlope + 1);
+	else
+		designHighCutFilter(chainSettings, sampleRate, highCut);
+}
+
+double getMagnitudeForFrequency(const ChainCoefficients &chainCoefficients, double frequency, double sampleRate) {
+	const auto &settings = chainCoefficients.settings;
+	auto magnitude = 1.0;
+	
+	if (! settings.lowCutBypassed)
+		magnitude *= getMagnitudeForFrequency(chainCoefficients.lowCut, frequency, sampleRate);
 	
-	leftChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-	rightChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+	if (! settings.peakBypassed)
+		magnitude *= getMagnitudeForFrequency(chainCoefficients.peak, frequency, sampleRate);
 	
-	updateCutFilter(leftLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
-	updateCutFilter(rightLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
+	if (! settings.highCutBypassed)
+		magnitude *= getMagnitudeForFrequency(chainCoefficients.highCut, frequency, sampleRate);
+	
+	return magnitude;
+}
+
+void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings, ChainCoefficients &chainCoefficients) {
+	designPeakFilter(chainSettings, getProcessingSampleRate(), chainCoefficients.peak);
+}
+
+void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings &chainSettings, ChainCoefficients &chainCoefficients) {
+	designLowCutFilter(chainSettings, getProcessingSampleRate(), cutTable.get(), chainCoefficients.lowCut);
 }
 
-void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings &chainSettings) {
-	auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings &chainSettings, ChainCoefficients &chainCoefficients) {
+	designHighCutFilter(chainSettings, getProcessingSampleRate(), cutTable.get(), chainCoefficients.highCut);
+}
+
+/* the design stage, never called on a realtime audio thread.
+ * it redesigns the bands that changed, copies the result into the free slot of the triple buffer
+ * and publishes it for applyPendingCoefficients() */
+void SimpleEQAudioProcessor::updateFilters() {
+	const juce::ScopedLock sl(designLock);
 	
-	auto &leftHighCut = leftChain.get<ChainPositions::HighCut>();
-	auto &rightHighCut = rightChain.get<ChainPositions::HighCut>();
+	// read the generations before the values, a change racing with us then just gets designed next time
+	auto generations = chainParameters.getGenerations();
+	auto chainSettings = chainParameters.getSettings();
 	
-	leftChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
-	rightChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+	auto &chainCoefficients = designedCoefficients;
+	chainCoefficients.settings = chainSettings;
+	
+	if (generations[LowCut] != designedGenerations[LowCut])
+		updateLowCutFilters(chainSettings, chainCoefficients);
+		
+	if (generations[Peak] != designedGenerations[Peak])
+		updatePeakFilter(chainSettings, chainCoefficients);
+		
+	if (generations[HighCut] != designedGenerations[HighCut])
+		updateHighCutFilters(chainSettings, chainCoefficients);
 	
-	updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
-	updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
+	designedGenerations = generations;
+	
+	coefficientSets.getWriteBuffer() = chainCoefficients;
+	coefficientSets.publish();
+	
+	if (linearPhaseMode) {
+		linearPhaseFilter.loadKernel([&chainCoefficients, sampleRate = getProcessingSampleRate()](double frequency) {
+			return getMagnitudeForFrequency(chainCoefficients, frequency, sampleRate);
+		});
+	}
 }
 
-void SimpleEQAudioProcessor::updateFilters() {
-	auto chainSettings = getChainSettings(apvts);
+void SimpleEQAudioProcessor::designIfNeeded() {
+	// nothing to design for until the host has told us the sample rate,
+	// and nothing to do while the audio thread ramps the coefficients itself (which is off by default).
+	// linear phase kernels are always built here
+	if (getProcessingSampleRate() <= 0 || (rampSubBlockSize.load() > 0 && ! linearPhaseMode))
+		return;
+	
+	const juce::ScopedLock sl(designLock);
+	
+	if (chainParameters.getGenerations() != designedGenerations)
+		updateFilters();
+}
+
+void SimpleEQAudioProcessor::setUsesCoefficientTables(bool shouldUseTables) {
+	if (shouldUseTables == usesCoefficientTables())
+		return;
 	
-	updateLowCutFilters(chainSettings);
-	updatePeakFilter(chainSettings);
-	updateHighCutFilters(chainSettings);
+	apvts.state.setProperty(coefficientTablesProperty, shouldUseTables, nullptr);
+	prepareCoefficientTables();
+	designIfNeeded();
+}
+
+bool SimpleEQAudioProcessor::usesCoefficientTables() const {
+	return apvts.state.getProperty(coefficientTablesProperty, false);
+}
+
+SimpleEQAudioProcessor::CoefficientTableStats SimpleEQAudioProcessor::getCoefficientTableStats() const {
+	const juce::ScopedLock sl(designLock);
+	
+	CoefficientTableStats stats;
+	
+	if (cutTable != nullptr) {
+		stats.memoryUsageInBytes = cutTable->getMemoryUsageInBytes();
+		stats.buildTimeInMilliseconds = cutTable->getBuildTimeInMilliseconds();
+	}
+	
+	return stats;
+}
+
+std::shared_ptr<const CutCoefficientTable> SimpleEQAudioProcessor::getCutTable() const {
+	const juce::ScopedLock sl(designLock);
+	return cutTable;
+}
+
+/* builds (or picks up the shared) table for the current sample rate, or drops it when the tables are off.
+ * building takes a while, so this only ever happens on the message thread.
+ * the ramp reads the table on the audio thread without locking, so it's swapped with the callback held off */
+void SimpleEQAudioProcessor::prepareCoefficientTables() {
+	std::shared_ptr<const CutCoefficientTable> table;
+	
+	if (usesCoefficientTables() && getProcessingSampleRate() > 0)
+		table = cutTableCache->getTable(getProcessingSampleRate());
+	
+	const juce::ScopedLock callbackLock(getCallbackLock());
+	const juce::ScopedLock sl(designLock);
+	
+	// the cut bands were designed the other way. a new generation gets the design thread to redesign them,
+	// and the ramp to run, which then redesigns them too even if their settings haven't moved
+	if (table != cutTable) {
+		coefficientRamp.invalidateCutFilters();
+		chainParameters.invalidate(LowCut);
+		chainParameters.invalidate(HighCut);
+	}
+	
+	// release the old table outside the lock, it might be the last reference
+	std::swap(cutTable, table);
+}
+
+void SimpleEQAudioProcessor::applyPendingCoefficients() {
+	if (! coefficientSets.acquire())
+		return;
+	
+	const auto &chainCoefficients = coefficientSets.getReadBuffer();
+	
+	installCoefficients(floatChainPool, chainCoefficients);
+	installCoefficients(doubleChainPool, chainCoefficients);
+	coefficientRamp.reset(chainCoefficients);
+}
+
+void SimpleEQAudioProcessor::setCoefficientRampSubBlockSize(int numSamples) {
+	numSamples = juce::jmax(0, numSamples);
+	
+	apvts.state.setProperty(coefficientRampSubBlockSizeProperty, numSamples, nullptr);
+	rampSubBlockSize = numSamples;
+	
+	// the design thread takes over again from here
+	if (numSamples == 0)
+		designIfNeeded();
+}
+
+void SimpleEQAudioProcessor::setOversamplingOrder(int order) {
+	order = juce::jlimit(0, maxOversamplingOrder, order);
+	
+	if (order == getOversamplingOrder())
+		return;
+	
+	apvts.state.setProperty(oversamplingOrderProperty, order, nullptr);
+	restartProcessing();
+}
+
+int SimpleEQAudioProcessor::getOversamplingOrder() const {
+	return juce::jlimit(0, maxOversamplingOrder, (int) apvts.state.getProperty(oversamplingOrderProperty, 0));
+}
+
+/* builds the up and down sampling stage for an order and the current precision, and returns the latency it adds.
+ * the polyphase IIR half-band filters are much cheaper than the FIR ones, their phase shift is similar to the eq's own */
+int SimpleEQAudioProcessor::prepareOversampling(int numChannels, int samplesPerBlock, int order) {
+	auto latency = 0;
+	
+	floatOversampling.reset();
+	doubleOversampling.reset();
+	oversamplingBlockSize = (size_t) juce::jmax(1, samplesPerBlock);
+	
+	auto prepare = [&](auto &oversampling) {
+		using Oversampling = typename std::remove_reference_t<decltype(oversampling)>::element_type;
+		
+		oversampling = std::make_unique<Oversampling>((size_t) numChannels, (size_t) order, Oversampling::filterHalfBandPolyphaseIIR, true, true);
+		oversampling->initProcessing((size_t) samplesPerBlock);
+		
+		latency = juce::roundToInt(oversampling->getLatencyInSamples());
+	};
+	
+	if (order > 0) {
+		if (isUsingDoublePrecision())
+			prepare(doubleOversampling);
+		else
+			prepare(floatOversampling);
+	}
+	
+	return latency;
+}
+
+void SimpleEQAudioProcessor::setUsesLinearPhase(bool shouldUseLinearPhase) {
+	if (shouldUseLinearPhase == usesLinearPhase())
+		return;
+	
+	apvts.state.setProperty(linearPhaseProperty, shouldUseLinearPhase, nullptr);
+	restartProcessing();
+}
+
+bool SimpleEQAudioProcessor::usesLinearPhase() const {
+	return apvts.state.getProperty(linearPhaseProperty, false);
+}
+
+void SimpleEQAudioProcessor::setLinearPhaseKernelLength(int kernelLength) {
+	kernelLength = LinearPhaseFilter::getValidKernelLength(kernelLength);
+	
+	if (kernelLength == getLinearPhaseKernelLength())
+		return;
+	
+	apvts.state.setProperty(linearPhaseKernelLengthProperty, kernelLength, nullptr);
+	
+	if (usesLinearPhase())
+		restartProcessing();
+}
+
+int SimpleEQAudioProcessor::getLinearPhaseKernelLength() const {
+	return LinearPhaseFilter::getValidKernelLength(apvts.state.getProperty(linearPhaseKernelLengthProperty, 4096));
+}
+
+void SimpleEQAudioProcessor::setChannelLinked(int channel, bool shouldBeLinked) {
+	if (! juce::isPositiveAndBelow(channel, maxUnlinkableChannels) || shouldBeLinked == isChannelLinked(channel))
+		return;
+	
+	apvts.state.setProperty(unlinkedChannelsProperty, (int) (getUnlinkedChannels() ^ (1u << channel)), nullptr);
+	
+	// the pools are only reconfigured while the audio callback is held off
+	restartProcessing();
+}
+
+bool SimpleEQAudioProcessor::isChannelLinked(int channel) const {
+	return ! juce::isPositiveAndBelow(channel, maxUnlinkableChannels) || (getUnlinkedChannels() & (1u << channel)) == 0;
+}
+
+juce::uint32 SimpleEQAudioProcessor::getUnlinkedChannels() const {
+	return (juce::uint32) (int) apvts.state.getProperty(unlinkedChannelsProperty, 0);
+}
+
+/* the freshly prepared pools link every channel, this unlinks the ones that shouldn't be filtered.
+ * with every band bypassed their lanes pass straight through, and the linked updates leave them that way */
+void SimpleEQAudioProcessor::applyChannelLinks() {
+	auto apply = [this](auto &chainPool) {
+		for (int channel = 0; channel < chainPool.getNumChannels(); ++channel)
+			if (! isChannelLinked(channel))
+				chainPool.setChannelCoefficients(channel, nullptr, nullptr, nullptr);
+	};
+	
+	apply(floatChainPool);
+	apply(doubleChainPool);
+}
+
+void SimpleEQAudioProcessor::setAnalyzerFFTOrder(int order) {
+	apvts.state.setProperty(analyzerFFTOrderProperty, juce::jlimit(minAnalyzerFFTOrder, maxAnalyzerFFTOrder, order), nullptr);
+}
+
+int SimpleEQAudioProcessor::getAnalyzerFFTOrder() const {
+	return juce::jlimit(minAnalyzerFFTOrder, maxAnalyzerFFTOrder, (int) apvts.state.getProperty(analyzerFFTOrderProperty, minAnalyzerFFTOrder));
+}
+
+void SimpleEQAudioProcessor::setAnalyzerOverlap(int overlap) {
+	apvts.state.setProperty(analyzerOverlapProperty, juce::nextPowerOfTwo(juce::jlimit(1, maxAnalyzerOverlap, overlap)), nullptr);
+}
+
+int SimpleEQAudioProcessor::getAnalyzerOverlap() const {
+	return juce::nextPowerOfTwo(juce::jlimit(1, maxAnalyzerOverlap, (int) apvts.state.getProperty(analyzerOverlapProperty, 4)));
+}
+
+void SimpleEQAudioProcessor::setAnalyzerMode(int mode) {
+	apvts.state.setProperty(analyzerModeProperty, juce::jlimit(0, numAnalyzerModes - 1, mode), nullptr);
+}
+
+int SimpleEQAudioProcessor::getAnalyzerMode() const {
+	return juce::jlimit(0, numAnalyzerModes - 1, (int) apvts.state.getProperty(analyzerModeProperty, 0));
+}
+
+/* the oversampling stage and the pools only get rebuilt in prepareToPlay, which the host won't call again by itself.
+ * the audio callback is held off meanwhile so processBlock can't run into them half built */
+void SimpleEQAudioProcessor::restartProcessing() {
+	if (getSampleRate() <= 0)
+		return;
+	
+	suspendProcessing(true);
+	prepareToPlay(getSampleRate(), getBlockSize());
+	suspendProcessing(false);
+}
+
+//==============================================================================
+ChainSettings CoefficientRamp::interpolate(const ChainSettings &from, const ChainSettings &to, float proportion) {
+	if (proportion >= 1.f)
+		return to;
+	
+	auto exponential = [proportion](float start, float end) { return start * std::pow(end / start, proportion); };
+	
+	auto settings = to;
+	
+	settings.lowCutFreq = exponential(from.lowCutFreq, to.lowCutFreq);
+	settings.highCutFreq = exponential(from.highCutFreq, to.highCutFreq);
+	settings.peakFreq = exponential(from.peakFreq, to.peakFreq);
+	settings.peakQuality = exponential(from.peakQuality, to.peakQuality);
+	settings.peakGainInDecibels = from.peakGainInDecibels + (to.peakGainInDecibels - from.peakGainInDecibels) * proportion;
+	
+	return settings;
+}
+
+void CoefficientRamp::design(const ChainSettings &settings, double sampleRate, const CutCoefficientTable *cutTable) {
+	const auto &current = coefficients.settings;
+	
+	// skip the bands that aren't moving, the cut designs are the expensive part
+	if (cutFiltersInvalid || settings.lowCutFreq != current.lowCutFreq || settings.lowCutSlope != current.lowCutSlope)
+		designLowCutFilter(settings, sampleRate, cutTable, coefficients.lowCut);
+	
+	if (settings.peakFreq != current.peakFreq || settings.peakQuality != current.peakQuality || settings.peakGainInDecibels != current.peakGainInDecibels)
+		designPeakFilter(settings, sampleRate, coefficients.peak);
+	
+	if (cutFiltersInvalid || settings.highCutFreq != current.highCutFreq || settings.highCutSlope != current.highCutSlope)
+		designHighCutFilter(settings, sampleRate, cutTable, coefficients.highCut);
+	
+	coefficients.settings = settings;
+	cutFiltersInvalid = false;
+}
+
+//==============================================================================
+CoefficientDesignThread::CoefficientDesignThread() : juce::Thread("SimpleEQ Coefficient Design") {
+	startThread();
+}
+
+CoefficientDesignThread::~CoefficientDesignThread() {
+	stopThread(1000);
+}
+
+void CoefficientDesignThread::add(SimpleEQAudioProcessor *processor) {
+	const juce::ScopedLock sl(lock);
+	processors.addIfNotAlreadyThere(processor);
+}
+
+void CoefficientDesignThread::remove(SimpleEQAudioProcessor *processor) {
+	// once this returns the thread can't be inside the processor any more
+	const juce::ScopedLock sl(lock);
+	processors.removeFirstMatchingValue(processor);
+}
+
+void CoefficientDesignThread::run() {
+	while (! threadShouldExit()) {
+		{
+			const juce::ScopedLock sl(lock);
+			
+			for (auto *processor : processors)
+				processor->designIfNeeded();
+		}
+		
+		// a change notifies the thread. one that came in during the pass above wakes it again right away
+		wait(designTimeoutMs);
+	}
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::createParameterLayout()
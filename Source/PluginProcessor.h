@@ -10,10 +10,18 @@
 
 #include <JuceHeader.h>
 
+#include "CpuLoadMeter.h"
+#include "FilterDesign.h"
+#include "LinearPhaseFilter.h"
+#include "VectorisedChain.h"
+
 #include <array>
+#include <atomic>
+#include <utility>
 
 // explained in other ppm for musicians courses
-template<typename T>
+// the slots are filled and emptied in place, so once they're sized nothing gets allocated or copied
+template<typename T, int Capacity = 30>
 struct Fifo
 {
     void prepare(int numChannels, int numSamples)
@@ -42,38 +50,60 @@ struct Fifo
         }
     }
     
-    bool push(const T& t)
+    /** producer side, fill(T&) writes the next free slot directly. false, without calling fill, when the fifo is full */
+    template<typename Fill>
+    bool write(Fill&& fill)
     {
         auto write = fifo.write(1);
         if( write.blockSize1 > 0 )
         {
-            buffers[write.startIndex1] = t;
+            fill(buffers[write.startIndex1]);
             return true;
         }
         
         return false;
     }
     
-    bool pull(T& t)
+    /** consumer side, use(T&) gets the oldest slot. it's handed back to the producer afterwards, so anything left in it gets overwritten */
+    template<typename Use>
+    bool read(Use&& use)
     {
         auto read = fifo.read(1);
         if( read.blockSize1 > 0 )
         {
-            t = buffers[read.startIndex1];
+            use(buffers[read.startIndex1]);
             return true;
         }
         
         return false;
     }
     
+    bool push(const T& t)
+    {
+        return write([&t](T& slot) { slot = t; });
+    }
+    
+    bool pull(T& t)
+    {
+        return read([&t](T& slot) { t = slot; });
+    }
+    
+    /** pull without a copy, t and the slot trade contents. the slot keeps t's storage for the producer to reuse */
+    bool swapOut(T& t)
+    {
+        return read([&t](T& slot) { std::swap(t, slot); });
+    }
+    
     int getNumAvailableForReading() const
     {
         return fifo.getNumReady();
     }
+    
+    static constexpr int getCapacity() { return Capacity; }
 private:
-    static constexpr int Capacity = 30;
-    std::array<T, Capacity> buffers;
-    juce::AbstractFifo fifo {Capacity};
+    // the fifo keeps one slot free, so Capacity of them are usable
+    std::array<T, Capacity + 1> buffers;
+    juce::AbstractFifo fifo {Capacity + 1};
 };
 
 enum Channel {
@@ -81,8 +111,79 @@ enum Channel {
 	Left // 1
 };
 
-// explained in other ppm for musicians courses
-template<typename BlockType>
+/* single producer, single consumer ring of samples. the producer writes whole blocks, the consumer reads
+ * straight out of the ring. either side is one or two copies, depending on whether it wraps around the end.
+ * when the consumer falls behind, whatever doesn't fit is dropped and counted as an overrun. */
+struct SampleRing
+{
+    /** not thread safe, call it while neither side is running */
+    void prepare(int capacity)
+    {
+        storage.assign((size_t) capacity + 1, 0.f);    // the fifo keeps one slot free
+        fifo.setTotalSize(capacity + 1);
+        fifo.reset();
+        numOverruns = 0;
+    }
+    
+    /** producer side. returns how many samples made it in */
+    template<typename SampleType>
+    int push(const SampleType* samples, int numSamples) noexcept
+    {
+        const auto numToWrite = juce::jmin(numSamples, fifo.getFreeSpace());
+        
+        if (numToWrite < numSamples)
+            numOverruns.fetch_add(1, std::memory_order_relaxed);
+        
+        const auto write = fifo.write(numToWrite);
+        copy(samples, write.startIndex1, write.blockSize1);
+        copy(samples + write.blockSize1, write.startIndex2, write.blockSize2);
+        
+        return numToWrite;
+    }
+    
+    struct ReadSpans
+    {
+        const float *data1 = nullptr, *data2 = nullptr;
+        int size1 = 0, size2 = 0;
+        
+        int getNumSamples() const { return size1 + size2; }
+    };
+    
+    /** consumer side. the oldest samples, up to maxSamples of them. they stay put until finishedRead() */
+    ReadSpans getReadSpans(int maxSamples) const
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(maxSamples, start1, size1, start2, size2);
+        
+        return { storage.data() + start1, storage.data() + start2, size1, size2 };
+    }
+    
+    void finishedRead(int numSamples) { fifo.finishedRead(numSamples); }
+    
+    int getNumReady() const { return fifo.getNumReady(); }
+    
+    /** pushes that didn't fit, since prepare */
+    int getNumOverruns() const { return numOverruns.load(std::memory_order_relaxed); }
+    
+private:
+    std::vector<float> storage;
+    juce::AbstractFifo fifo { 1 };
+    std::atomic<int> numOverruns { 0 };
+    
+    template<typename SampleType>
+    void copy(const SampleType* source, int startIndex, int numSamples) noexcept
+    {
+        if (numSamples <= 0)
+            return;
+        
+        if constexpr (std::is_same_v<SampleType, float>)
+            juce::FloatVectorOperations::copy(storage.data() + startIndex, source, numSamples);
+        else
+            std::transform(source, source + numSamples, storage.data() + startIndex, [](SampleType x) { return (float) x; });
+    }
+};
+
+// the analyzer's tap on one channel of the processed audio
 struct SingleChannelSampleFifo
 {
     SingleChannelSampleFifo(Channel ch) : channelToUse(ch)
@@ -90,60 +191,46 @@ struct SingleChannelSampleFifo
         prepared.set(false);
     }
     
-    void update(const BlockType& buffer)
+    // takes float or double buffers, the analyzer only ever needs floats
+    template<typename BufferType>
+    void update(const BufferType& buffer)
     {
         jassert(prepared.get());
-        jassert(buffer.getNumChannels() > channelToUse );
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
+        jassert(buffer.getNumChannels() > 0);
+        // a mono bus only has the one channel, both taps read it then
+        auto* channelPtr = buffer.getReadPointer(juce::jmin((int) channelToUse, buffer.getNumChannels() - 1));
         
-        for( int i = 0; i < buffer.getNumSamples(); ++i )
-        {
-            pushNextSampleIntoFifo(channelPtr[i]);
-        }
+        ring.push(channelPtr, buffer.getNumSamples());
     }
 
     void prepare(int bufferSize)
     {
+        const juce::ScopedLock sl(readLock);
+        
         prepared.set(false);
         size.set(bufferSize);
         
-        bufferToFill.setSize(1,             //channel
-                             bufferSize,    //num samples
-                             false,         //keepExistingContent
-                             true,          //clear extra space
-                             true);         //avoid reallocating
-        audioBufferFifo.prepare(1, bufferSize);
-        fifoIndex = 0;
+        // 30 blocks, and at least enough for the analyzer's biggest hop a few times over
+        ring.prepare(juce::jmax(bufferSize * 30, 1 << 15));
         prepared.set(true);
     }
     //==============================================================================
-    int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
+    int getNumSamplesAvailable() const { return ring.getNumReady(); }
     bool isPrepared() const { return prepared.get(); }
     int getSize() const { return size.get(); }
+    int getNumOverruns() const { return ring.getNumOverruns(); }
     //==============================================================================
-    bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
+    SampleRing::ReadSpans getReadSpans(int maxSamples) const { return ring.getReadSpans(maxSamples); }
+    void finishedRead(int numSamples) { ring.finishedRead(numSamples); }
+    
+    /** the reader holds this while it reads, so prepare() can't pull the ring out from under it */
+    const juce::CriticalSection &getReadLock() const { return readLock; }
 private:
     Channel channelToUse;
-    int fifoIndex = 0;
-    Fifo<BlockType> audioBufferFifo;
-    BlockType bufferToFill;
+    SampleRing ring;
+    juce::CriticalSection readLock;
     juce::Atomic<bool> prepared = false;
     juce::Atomic<int> size = 0;
-    
-    void pushNextSampleIntoFifo(float sample)
-    {
-        if (fifoIndex == bufferToFill.getNumSamples())
-        {
-            auto ok = audioBufferFifo.push(bufferToFill);
-
-            juce::ignoreUnused(ok);
-            
-            fifoIndex = 0;
-        }
-        
-        bufferToFill.setSample(0, fifoIndex, sample);
-        ++fifoIndex;
-    }
 };
 
 enum Slope {
@@ -162,13 +249,14 @@ struct ChainSettings {
 	bool lowCutBypassed { false }, peakBypassed { false }, highCutBypassed { false };
 };
 
-ChainSettings getChainSettings (juce::AudioProcessorValueTreeState &apvts);
+template<typename SampleType>
+using FilterType = juce::dsp::IIR::Filter<SampleType>;
 
-using Filter = juce::dsp::IIR::Filter<float>;
-	
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-	
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+template<typename SampleType>
+using CutFilterType = juce::dsp::ProcessorChain<FilterType<SampleType>, FilterType<SampleType>, FilterType<SampleType>, FilterType<SampleType>>;
+
+template<typename SampleType>
+using MonoChainType = juce::dsp::ProcessorChain<CutFilterType<SampleType>, FilterType<SampleType>, CutFilterType<SampleType>>;
 
 enum ChainPositions {
 		LowCut,
@@ -176,48 +264,179 @@ enum ChainPositions {
 		HighCut
 };
 
-using Coefficients = Filter::CoefficientsPtr;
+/* reads ChainSettings without looking anything up by name, the parameters are resolved once on construction.
+ * each band also has a generation counter that is bumped whenever one of its parameters changes,
+ * so readers can tell in O(1) which bands need redesigning, and onChange tells them when to look. */
+struct ChainParameters : juce::AudioProcessorParameter::Listener {
+	using Generations = std::array<juce::uint32, 3>;
+	
+	ChainParameters(juce::AudioProcessorValueTreeState &);
+	~ChainParameters() override;
+	
+	ChainSettings getSettings() const;
+	
+	juce::uint32 getGeneration(ChainPositions band) const { return generations[band].load(); }
+	Generations getGenerations() const { return { getGeneration(LowCut), getGeneration(Peak), getGeneration(HighCut) }; }
+	
+	/** marks a band as changed, e.g. when the way it's designed changes */
+	void invalidate(ChainPositions band);
+	
+	/** marks every band as changed, e.g. when the sample rate changes */
+	void invalidateAll();
+	
+	/** called after a generation was bumped, on whichever thread changed the parameter, so it mustn't block */
+	std::function<void()> onChange;
+	
+	void parameterValueChanged (int parameterIndex, float newValue) override;
+	void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override { }
+	
+private:
+	// the parameters store their value before notifying listeners (the apvts raw values are updated by a listener of their own),
+	// so reading them directly guarantees a bumped generation never comes with a stale value
+	juce::AudioParameterFloat *lowCutFreq, *highCutFreq, *peakFreq, *peakGain, *peakQuality;
+	juce::AudioParameterChoice *lowCutSlope, *highCutSlope;
+	juce::AudioParameterBool *lowCutBypassed, *peakBypassed, *highCutBypassed;
 	
-void updateCoefficients(Coefficients &, const Coefficients &);
+	// maps a parameter index to the band it belongs to, -1 for parameters outside the chain
+	std::vector<int> bandForParameterIndex;
+	juce::Array<juce::AudioProcessorParameter*> listenedParameters;
+	
+	std::array<std::atomic<juce::uint32>, 3> generations;
+	
+	void listenTo(juce::AudioProcessorParameter *, ChainPositions);
+};
 
-Coefficients makePeakFilter(const ChainSettings &, double sampleRate);
+void designPeakFilter(const ChainSettings &, double sampleRate, BiquadCoefficients &);
+void designLowCutFilter(const ChainSettings &, double sampleRate, CutCoefficients &);
+void designHighCutFilter(const ChainSettings &, double sampleRate, CutCoefficients &);
 
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType &chain, const CoefficientType &coefficients) {
-	updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-	chain.template setBypassed<Index>(false);
+/* the same cut designs, looked up instead when there's a table for the sample rate */
+void designLowCutFilter(const ChainSettings &, double sampleRate, const CutCoefficientTable *, CutCoefficients &);
+void designHighCutFilter(const ChainSettings &, double sampleRate, const CutCoefficientTable *, CutCoefficients &);
+
+/* the designed sections of the whole chain, plain data so designing never allocates */
+struct ChainCoefficients {
+	ChainSettings settings;
+	
+	BiquadCoefficients peak;
+	CutCoefficients lowCut, highCut;
+};
+
+/* the gain of the whole chain at a frequency, leaving out the bypassed bands */
+double getMagnitudeForFrequency(const ChainCoefficients &, double frequency, double sampleRate);
+
+/* hands the designed sections to a VectorisedChain or ChannelChainPool, leaving out the bypassed bands */
+template<typename ChainType>
+void installCoefficients(ChainType &chain, const ChainCoefficients &chainCoefficients) {
+	const auto &settings = chainCoefficients.settings;
+	
+	chain.setCoefficients(settings.lowCutBypassed ? nullptr : &chainCoefficients.lowCut,
+						  settings.peakBypassed ? nullptr : &chainCoefficients.peak,
+						  settings.highCutBypassed ? nullptr : &chainCoefficients.highCut);
 }
+
+/* moves the chain from its current settings to new ones across a block without zippering.
+ * the block is split into sub-blocks, the continuous parameters are interpolated across them
+ * and the bands that move get redesigned at every sub-block edge. the closed form designs and the
+ * table lookups never allocate, so this runs on the audio thread. */
+struct CoefficientRamp {
+	/** jumps straight to a design, e.g. after prepareToPlay */
+	void reset(const ChainCoefficients &current) { coefficients = current; }
+	
+	/** the cut filters get redesigned on the next sub-block even if their settings don't move,
+	 * e.g. after the coefficient tables were switched on or off. only call this while the audio callback is held off */
+	void invalidateCutFilters() { cutFiltersInvalid = true; }
+	
+	const ChainSettings &getSettings() const { return coefficients.settings; }
 	
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType &chain, const CoefficientType &coefficients, const Slope &slope) {
-	chain.template setBypassed<0>(true);
-	chain.template setBypassed<1>(true);
-	chain.template setBypassed<2>(true);
-	chain.template setBypassed<3>(true);
+	/** the cut filters are looked up in cutTable when there is one, it has to be for sampleRate */
+	template<typename ChainType, typename SampleType>
+	void process(ChainType &chain, const juce::dsp::AudioBlock<SampleType> &block, const ChainSettings &target, double sampleRate, int subBlockSize,
+				 const CutCoefficientTable *cutTable = nullptr) {
+		jassert(subBlockSize > 0);
 		
-	switch (slope) {
-		case Slope_48: {
-			update<3>(chain, coefficients);
-		}
-		case Slope_36: {
-			update<2>(chain, coefficients);
-		}
-		case Slope_24: {
-			update<1>(chain, coefficients);
-		}
-		case Slope_12: {
-			update<0>(chain, coefficients);
+		const auto start = coefficients.settings;
+		const auto numSamples = (int) block.getNumSamples();
+		const auto numSubBlocks = (numSamples + subBlockSize - 1) / subBlockSize;
+		
+		for (int subBlock = 0; subBlock < numSubBlocks; ++subBlock) {
+			const auto offset = subBlock * subBlockSize;
+			
+			const auto designStart = juce::Time::getHighResolutionTicks();
+			
+			// each sub-block runs at the settings reached by its end, the last one lands on the target
+			design(interpolate(start, target, float(subBlock + 1) / float(numSubBlocks)), sampleRate, cutTable);
+			installCoefficients(chain, coefficients);
+			
+			designTicks += juce::Time::getHighResolutionTicks() - designStart;
+			
+			chain.process(block.getSubBlock((size_t) offset, (size_t) juce::jmin(subBlockSize, numSamples - offset)));
 		}
 	}
-}
+	
+	/** frequencies and Q move exponentially, gain linearly in dB. slopes and bypasses can't be interpolated, they switch right away */
+	static ChainSettings interpolate(const ChainSettings &from, const ChainSettings &to, float proportion);
+	
+	/** time spent designing and installing since the last call, for the cpu load meter */
+	juce::int64 takeDesignTicks() { return std::exchange(designTicks, 0); }
+	
+private:
+	ChainCoefficients coefficients;
+	juce::int64 designTicks = 0;
+	bool cutFiltersInvalid = false;
+	
+	void design(const ChainSettings &, double sampleRate, const CutCoefficientTable *);
+};
 
-inline auto makeLowCutFilter(const ChainSettings &chainSettings, double sampleRate) {
-	return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, (chainSettings.lowCutSlope + 1) * 2);
-}
+/* wait-free handoff between one writer and one reader.
+ * the writer fills getWriteBuffer() and publishes it, the reader acquires the most recently published buffer.
+ * the three slots just rotate between the two sides, so neither of them ever blocks or allocates. */
+template<typename T>
+struct TripleBuffer {
+	T &getWriteBuffer() { return buffers[writeIndex]; }
+	
+	void publish() {
+		writeIndex = shared.exchange(writeIndex | newDataFlag) & indexMask;
+	}
+	
+	bool acquire() {
+		if ((shared.load() & newDataFlag) == 0)
+			return false;
+		
+		readIndex = shared.exchange(readIndex) & indexMask;
+		return true;
+	}
+	
+	const T &getReadBuffer() const { return buffers[readIndex]; }
+	
+private:
+	static constexpr int indexMask = 3, newDataFlag = 4;
+	
+	std::array<T, 3> buffers;
+	int writeIndex { 0 }, readIndex { 1 };
+	std::atomic<int> shared { 2 };
+};
 
-inline auto makeHighCutFilter(const ChainSettings &chainSettings, double sampleRate) {
-	return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, (chainSettings.highCutSlope + 1) * 2);
-}
+class SimpleEQAudioProcessor;
+
+/* one background thread shared by every instance.
+ * it sleeps until a processor's parameters change, then redesigns the coefficients of those that need it. */
+struct CoefficientDesignThread : juce::Thread {
+	CoefficientDesignThread();
+	~CoefficientDesignThread() override;
+	
+	void add(SimpleEQAudioProcessor *);
+	void remove(SimpleEQAudioProcessor *);
+	
+	void run() override;
+	
+private:
+	// a change always notifies the thread, this is only a fallback
+	static constexpr int designTimeoutMs = 1000;
+	
+	juce::CriticalSection lock;
+	juce::Array<SimpleEQAudioProcessor*> processors;
+};
 
 //==============================================================================
 /**
@@ -241,6 +460,10 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    
+    /** the chain runs natively in either precision, so 64 bit hosts don't have to convert every buffer */
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -265,23 +488,172 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
+    //==============================================================================
+    /** redesigns and publishes the coefficients if any band changed since the last design. */
+    void designIfNeeded();
+    
+    /** table driven mode, the cut filters are looked up in per sample rate tables instead of being designed.
+        costs memory (see getCoefficientTableStats()) but makes redesigning a cut filter an index lookup.
+        the setting is saved with the plugin state. */
+    void setUsesCoefficientTables(bool shouldUseTables);
+    bool usesCoefficientTables() const;
+    
+    struct CoefficientTableStats {
+        size_t memoryUsageInBytes = 0;
+        double buildTimeInMilliseconds = 0;
+    };
+    
+    /** the cost of the table in use, all zero when the tables are off or not built yet.
+        instances running at the same sample rate share one table. */
+    CoefficientTableStats getCoefficientTableStats() const;
+    
+    /** the table the cut filters are looked up in at getProcessingSampleRate(), null while they're designed.
+        the cut bands' generations move whenever it's swapped, so anything designing from it knows to look again. */
+    std::shared_ptr<const CutCoefficientTable> getCutTable() const;
+    
+    /** automation is ramped in sub-blocks of this many samples, the coefficients are redesigned at every sub-block edge.
+        smaller sub-blocks are smoother and cost more. while ramping, the bands that move are designed on the audio thread
+        (or looked up, with the coefficient tables on), and the design thread only builds linear phase kernels.
+        0, the default, leaves all the designing to the design thread and updates the coefficients once per block.
+        the setting is saved with the plugin state. */
+    void setCoefficientRampSubBlockSize(int numSamples);
+    int getCoefficientRampSubBlockSize() const { return rampSubBlockSize.load(); }
+    
+    /** runs the chain at 2^order times the host rate (0 is off, up to maxOversamplingOrder), through polyphase
+        half-band filters. keeps the peak and high cut from cramping near nyquist, at the cost of CPU and latency,
+        which is reported to the host. the setting is saved with the plugin state. */
+    void setOversamplingOrder(int order);
+    int getOversamplingOrder() const;
+    
+    static constexpr int maxOversamplingOrder = 2;
+    
+    /** linear phase mode, the chain's magnitude response is run as an FIR of the given length instead of the IIR chain.
+        the latency is half the kernel length, longer kernels resolve the low cut better and cost more.
+        oversampling isn't used in this mode. both settings are saved with the plugin state. */
+    void setUsesLinearPhase(bool shouldUseLinearPhase);
+    bool usesLinearPhase() const;
+    
+    void setLinearPhaseKernelLength(int kernelLength);
+    int getLinearPhaseKernelLength() const;
+    
+    /** an unlinked channel is left out of the IIR chain and passes through unfiltered, e.g. the LFE channel of a 5.1 stem.
+        every channel is linked by default, and only the first maxUnlinkableChannels can be unlinked.
+        linear phase mode still filters every channel. the setting is saved with the plugin state. */
+    void setChannelLinked(int channel, bool shouldBeLinked);
+    bool isChannelLinked(int channel) const;
+    
+    static constexpr int maxUnlinkableChannels = 32;
+    
+    /** the rate the chain runs and gets designed at, the host rate times the oversampling factor */
+    double getProcessingSampleRate() const { return processingSampleRate.load(); }
+    
+    /** how much of its deadline each recent processBlock used. safe to read from any thread, cleared by prepareToPlay. */
+    const CpuLoadMeter &getCpuLoadMeter() const { return cpuLoadMeter; }
+    
+    /** the analyzer's FFT is 2^order points, and a new one starts every 1/overlap of that, however big the host's blocks are.
+        only the editor uses these, they're saved with the plugin state. */
+    void setAnalyzerFFTOrder(int order);
+    int getAnalyzerFFTOrder() const;
+    
+    void setAnalyzerOverlap(int overlap);
+    int getAnalyzerOverlap() const;
+    
+    static constexpr int minAnalyzerFFTOrder = 11, maxAnalyzerFFTOrder = 13, maxAnalyzerOverlap = 8;
+    
+    /** one of the editor's AnalyzerMode values: each frame as it is, an exponential average, or peak hold */
+    void setAnalyzerMode(int mode);
+    int getAnalyzerMode() const;
+    
+    static constexpr int numAnalyzerModes = 3;
+    
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     
 	juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameterLayout()};
+	ChainParameters chainParameters { apvts };
 	
-	using BlockType = juce::AudioBuffer<float>;
-	SingleChannelSampleFifo<BlockType> leftChannelFifo { Channel::Left };
-	SingleChannelSampleFifo<BlockType> rightChannelFifo { Channel::Right };
+	SingleChannelSampleFifo leftChannelFifo { Channel::Left };
+	SingleChannelSampleFifo rightChannelFifo { Channel::Right };
 
 private:
-	MonoChain leftChain, rightChain;
+	// only the pool matching the host's processing precision gets prepared
+	ChannelChainPool<float> floatChainPool;
+	ChannelChainPool<double> doubleChainPool;
+	
+	template<typename SampleType>
+	ChannelChainPool<SampleType> &getChainPool() {
+		if constexpr (std::is_same_v<SampleType, double>)
+			return doubleChainPool;
+		else
+			return floatChainPool;
+	}
+	
+	// like the pools, only the stage matching the precision exists, and only while oversampling
+	std::unique_ptr<juce::dsp::Oversampling<float>> floatOversampling;
+	std::unique_ptr<juce::dsp::Oversampling<double>> doubleOversampling;
+	
+	template<typename SampleType>
+	std::unique_ptr<juce::dsp::Oversampling<SampleType>> &getOversampling() {
+		if constexpr (std::is_same_v<SampleType, double>)
+			return doubleOversampling;
+		else
+			return floatOversampling;
+	}
+	
+	std::atomic<double> processingSampleRate { 0 };
+	
+	// the most host samples the oversampling stage takes at once
+	size_t oversamplingBlockSize = 1;
+	
+	int prepareOversampling(int numChannels, int samplesPerBlock, int order);
+	void restartProcessing();
+	
+	// one bit per channel, set for the unlinked ones
+	juce::uint32 getUnlinkedChannels() const;
+	void applyChannelLinks();
+	
+	// set in prepareToPlay, the design thread reads it as well
+	std::atomic<bool> linearPhaseMode { false };
+	LinearPhaseFilter linearPhaseFilter;
+	
+	template<typename SampleType>
+	void processSamples(juce::AudioBuffer<SampleType> &);
+	
+	template<typename SampleType>
+	void processChain(const juce::dsp::AudioBlock<SampleType> &);
+	
+	template<typename SampleType>
+	void processChainAtProcessingRate(const juce::dsp::AudioBlock<SampleType> &, int oversamplingFactor);
+	
+	TripleBuffer<ChainCoefficients> coefficientSets;
+	juce::CriticalSection designLock;
+	
+	// the designer's own copy of the latest design, only the bands whose generation moved get redesigned into it
+	ChainCoefficients designedCoefficients;
+	ChainParameters::Generations designedGenerations {};
+	
+	juce::SharedResourcePointer<CutCoefficientTableCache> cutTableCache;
+	std::shared_ptr<const CutCoefficientTable> cutTable;
+	
+	void prepareCoefficientTables();
+	
+	// off by default, so the design thread does all the designing. see setCoefficientRampSubBlockSize()
+	std::atomic<int> rampSubBlockSize { 0 };
+	
+	// only touched on the audio thread
+	CoefficientRamp coefficientRamp;
+	ChainParameters::Generations rampGenerations {};
+	
+	CpuLoadMeter cpuLoadMeter;
+	
+	juce::SharedResourcePointer<CoefficientDesignThread> designThread;
 	
-	void updatePeakFilter(const ChainSettings &);
+	void updatePeakFilter(const ChainSettings &, ChainCoefficients &);
 	
-	void updateLowCutFilters(const ChainSettings &);
-	void updateHighCutFilters(const ChainSettings &);
+	void updateLowCutFilters(const ChainSettings &, ChainCoefficients &);
+	void updateHighCutFilters(const ChainSettings &, ChainCoefficients &);
 	
 	void updateFilters();
+	void applyPendingCoefficients();
 	
 	juce::dsp::Oscillator<float> osc;
 	
@@ -0,0 +1,244 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.cpp
+    Catches heap allocations and blocking locks on the audio thread, in builds made to look for them.
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafety.h"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <cxxabi.h>
+ #include <dlfcn.h>
+#endif
+
+#if JUCE_MSVC
+ #include <intrin.h>
+ #include <malloc.h>
+ #define SIMPLEEQ_CALL_SITE _ReturnAddress()
+#else
+ #define SIMPLEEQ_CALL_SITE __builtin_return_address(0)
+#endif
+
+namespace {
+	// plain thread locals without constructors, so touching them never allocates, not even inside operator new
+	thread_local int realtimeDepth = 0;
+	thread_local bool isNoting = false;
+	thread_local int blockAllocations = 0, blockDeallocations = 0, blockLocks = 0;
+	
+	std::atomic<juce::int64> numBlocks { 0 }, numBlocksWithViolations { 0 };
+	std::atomic<juce::int64> numAllocations { 0 }, numDeallocations { 0 }, numLocks { 0 };
+	std::atomic<int> mostViolationsInOneBlock { 0 };
+	
+	// a ring of the latest violations, written lock free from any realtime thread
+	constexpr int maxRecentViolations = 64;
+	std::array<std::atomic<const void*>, maxRecentViolations> recentCallSites {};
+	std::array<std::atomic<int>, maxRecentViolations> recentTypes {};
+	std::atomic<juce::uint32> numRecentViolations { 0 };
+}
+
+namespace RealtimeSafety {
+	void noteViolation(ViolationType type, const void *callSite) noexcept {
+		if (realtimeDepth == 0 || isNoting)
+			return;
+		
+		isNoting = true;
+		
+		switch (type) {
+			case ViolationType::allocation: ++blockAllocations; break;
+			case ViolationType::deallocation: ++blockDeallocations; break;
+			case ViolationType::lock: ++blockLocks; break;
+		}
+		
+		const auto index = numRecentViolations.fetch_add(1) % maxRecentViolations;
+		recentCallSites[index] = callSite;
+		recentTypes[index] = (int) type;
+		
+		isNoting = false;
+	}
+	
+   #if SIMPLEEQ_RT_SAFETY_CHECKS
+	ScopedRealtimeSection::ScopedRealtimeSection(bool isRealtime) noexcept : active(isRealtime) {
+		if (! active)
+			return;
+		
+		if (realtimeDepth++ == 0)
+			blockAllocations = blockDeallocations = blockLocks = 0;
+	}
+	
+	ScopedRealtimeSection::~ScopedRealtimeSection() noexcept {
+		if (! active || --realtimeDepth > 0)
+			return;
+		
+		const auto violations = blockAllocations + blockDeallocations + blockLocks;
+		
+		++numBlocks;
+		numAllocations += blockAllocations;
+		numDeallocations += blockDeallocations;
+		numLocks += blockLocks;
+		
+		if (violations > 0) {
+			++numBlocksWithViolations;
+			
+			auto most = mostViolationsInOneBlock.load();
+			while (violations > most && ! mostViolationsInOneBlock.compare_exchange_weak(most, violations)) { }
+		}
+	}
+   #endif
+	
+	Report getReport() {
+		Report report;
+		report.numBlocks = numBlocks;
+		report.numBlocksWithViolations = numBlocksWithViolations;
+		report.numAllocations = numAllocations;
+		report.numDeallocations = numDeallocations;
+		report.numLocks = numLocks;
+		report.mostViolationsInOneBlock = mostViolationsInOneBlock;
+		
+		const auto numRecent = numRecentViolations.load();
+		const auto first = numRecent > (juce::uint32) maxRecentViolations ? numRecent - maxRecentViolations : 0;
+		
+		for (auto i = first; i < numRecent; ++i)
+			report.recentViolations.push_back({ (ViolationType) recentTypes[i % maxRecentViolations].load(), recentCallSites[i % maxRecentViolations].load() });
+		
+		return report;
+	}
+	
+	void resetReport() {
+		numBlocks = numBlocksWithViolations = 0;
+		numAllocations = numDeallocations = numLocks = 0;
+		mostViolationsInOneBlock = 0;
+		numRecentViolations = 0;
+	}
+	
+	juce::String describe(const Violation &violation) {
+		juce::String description;
+		
+		switch (violation.type) {
+			case ViolationType::allocation: description = "allocation"; break;
+			case ViolationType::deallocation: description = "deallocation"; break;
+			case ViolationType::lock: description = "lock"; break;
+		}
+		
+		description << " at " << juce::String::toHexString((juce::pointer_sized_int) violation.callSite);
+		
+	   #if JUCE_LINUX || JUCE_MAC
+		// symbols are often hidden or stripped, so the module offset may be all there is, feed it to addr2line or atos
+		Dl_info info;
+		
+		if (dladdr(violation.callSite, &info) != 0) {
+			description << " (" << juce::File(info.dli_fname).getFileName() << " + 0x"
+						<< juce::String::toHexString((juce::pointer_sized_int) violation.callSite - (juce::pointer_sized_int) info.dli_fbase);
+			
+			if (info.dli_sname != nullptr) {
+				int status = 0;
+				auto *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+				description << ", " << (status == 0 ? demangled : info.dli_sname);
+				std::free(demangled);
+			}
+			
+			description << ")";
+		}
+	   #endif
+		
+		return description;
+	}
+}
+
+//==============================================================================
+#if SIMPLEEQ_RT_SAFETY_CHECKS
+
+// these replace the global operators only because they're linked into the executable itself,
+// see RealtimeSafety.h for why plugin builds can't use them
+namespace {
+	void *allocate(std::size_t size, const void *callSite) noexcept {
+		RealtimeSafety::noteViolation(RealtimeSafety::ViolationType::allocation, callSite);
+		return std::malloc(size == 0 ? 1 : size);
+	}
+	
+	void *allocateAligned(std::size_t size, std::align_val_t alignment, const void *callSite) noexcept {
+		RealtimeSafety::noteViolation(RealtimeSafety::ViolationType::allocation, callSite);
+		
+	   #if JUCE_MSVC
+		return _aligned_malloc(size == 0 ? 1 : size, (std::size_t) alignment);
+	   #else
+		void *pointer = nullptr;
+		return posix_memalign(&pointer, juce::jmax((std::size_t) alignment, sizeof(void*)), size == 0 ? 1 : size) == 0 ? pointer : nullptr;
+	   #endif
+	}
+	
+	void deallocate(void *pointer, const void *callSite) noexcept {
+		if (pointer == nullptr)
+			return;
+		
+		RealtimeSafety::noteViolation(RealtimeSafety::ViolationType::deallocation, callSite);
+		std::free(pointer);
+	}
+	
+	void deallocateAligned(void *pointer, const void *callSite) noexcept {
+		if (pointer == nullptr)
+			return;
+		
+		RealtimeSafety::noteViolation(RealtimeSafety::ViolationType::deallocation, callSite);
+		
+	   #if JUCE_MSVC
+		_aligned_free(pointer);
+	   #else
+		std::free(pointer);
+	   #endif
+	}
+	
+	template<typename Pointer>
+	Pointer throwIfNull(Pointer pointer) {
+		if (pointer == nullptr)
+			throw std::bad_alloc();
+		
+		return pointer;
+	}
+}
+
+void *operator new(std::size_t size) { return throwIfNull(allocate(size, SIMPLEEQ_CALL_SITE)); }
+void *operator new[](std::size_t size) { return throwIfNull(allocate(size, SIMPLEEQ_CALL_SITE)); }
+void *operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size, SIMPLEEQ_CALL_SITE); }
+void *operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size, SIMPLEEQ_CALL_SITE); }
+
+void *operator new(std::size_t size, std::align_val_t alignment) { return throwIfNull(allocateAligned(size, alignment, SIMPLEEQ_CALL_SITE)); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return throwIfNull(allocateAligned(size, alignment, SIMPLEEQ_CALL_SITE)); }
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment, SIMPLEEQ_CALL_SITE); }
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment, SIMPLEEQ_CALL_SITE); }
+
+void operator delete(void *pointer) noexcept { deallocate(pointer, SIMPLEEQ_CALL_SITE); }
+void operator delete[](void *pointer) noexcept { deallocate(pointer, SIMPLEEQ_CALL_SITE); }
+void operator delete(void *pointer, std::size_t) noexcept { deallocate(pointer, SIMPLEEQ_CALL_SITE); }
+void operator delete[](void *pointer, std::size_t) noexcept { deallocate(pointer, SIMPLEEQ_CALL_SITE); }
+void operator delete(void *pointer, const std::nothrow_t&) noexcept { deallocate(pointer, SIMPLEEQ_CALL_SITE); }
+void operator delete[](void *pointer, const std::nothrow_t&) noexcept { deallocate(pointer, SIMPLEEQ_CALL_SITE); }
+
+void operator delete(void *pointer, std::align_val_t) noexcept { deallocateAligned(pointer, SIMPLEEQ_CALL_SITE); }
+void operator delete[](void *pointer, std::align_val_t) noexcept { deallocateAligned(pointer, SIMPLEEQ_CALL_SITE); }
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept { deallocateAligned(pointer, SIMPLEEQ_CALL_SITE); }
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept { deallocateAligned(pointer, SIMPLEEQ_CALL_SITE); }
+void operator delete(void *pointer, std::align_val_t, const std::nothrow_t&) noexcept { deallocateAligned(pointer, SIMPLEEQ_CALL_SITE); }
+void operator delete[](void *pointer, std::align_val_t, const std::nothrow_t&) noexcept { deallocateAligned(pointer, SIMPLEEQ_CALL_SITE); }
+
+#if JUCE_LINUX
+/* juce::CriticalSection and std::mutex both end up here on linux. defined in the executable, this comes before libc's
+ * in symbol lookup, so it sees every lock in the process and looks the real one up behind it. in a dlopened library
+ * it wouldn't: calls are already bound to libc's by then. try-locks don't block, so they're left alone */
+extern "C" int pthread_mutex_lock(pthread_mutex_t *mutex) {
+	using LockFunction = int (*)(pthread_mutex_t*);
+	static const auto realLock = reinterpret_cast<LockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+	
+	RealtimeSafety::noteViolation(RealtimeSafety::ViolationType::lock, SIMPLEEQ_CALL_SITE);
+	return realLock(mutex);
+}
+#endif
+
+#endif
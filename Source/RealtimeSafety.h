@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.h
+    Catches heap allocations and blocking locks on the audio thread, in builds made to look for them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <vector>
+
+// build with SIMPLEEQ_RT_SAFETY_CHECKS=1 to replace the global operator new and delete (and pthread_mutex_lock on linux)
+// with versions that report what happens inside a realtime section. everywhere else it all compiles away.
+//
+// the replacements only catch everything when they're linked into the executable, as in the benchmarks' --check-realtime.
+// a plugin is a library the host dlopens, and there the host's and libc's definitions are already bound:
+// pthread_mutex_lock calls go straight to libc, so locks aren't seen at all, and allocations are only caught
+// where the plugin's own code calls operator new, not in the host, libc or other libraries the plugin calls into.
+// so plugin builds refuse the flag rather than report a clean block that wasn't.
+#ifndef SIMPLEEQ_RT_SAFETY_CHECKS
+ #define SIMPLEEQ_RT_SAFETY_CHECKS 0
+#endif
+
+#if SIMPLEEQ_RT_SAFETY_CHECKS && defined (JucePlugin_Build_VST3)
+ #error "SIMPLEEQ_RT_SAFETY_CHECKS only works in executables, check the processor with the benchmarks' --check-realtime"
+#endif
+
+namespace RealtimeSafety {
+	enum class ViolationType {
+		allocation,
+		deallocation,
+		lock
+	};
+	
+	struct Violation {
+		ViolationType type;
+		const void *callSite;
+	};
+	
+	/* what the realtime sections ran into since the last resetReport(). a section is one processBlock */
+	struct Report {
+		juce::int64 numBlocks = 0, numBlocksWithViolations = 0;
+		juce::int64 numAllocations = 0, numDeallocations = 0, numLocks = 0;
+		int mostViolationsInOneBlock = 0;
+		
+		// the latest ones, oldest first
+		std::vector<Violation> recentViolations;
+		
+		juce::int64 getNumViolations() const { return numAllocations + numDeallocations + numLocks; }
+	};
+	
+	constexpr bool isEnabled() { return SIMPLEEQ_RT_SAFETY_CHECKS != 0; }
+	
+	Report getReport();
+	void resetReport();
+	
+	/** the function or module and offset of a call site, for printing. don't call it from a realtime section */
+	juce::String describe(const Violation &);
+	
+	/** called by the hooks */
+	void noteViolation(ViolationType, const void *callSite) noexcept;
+	
+	/* marks the calling thread as realtime for its lifetime, e.g. around processBlock.
+	 * sections can nest, the outermost one counts as the block */
+   #if SIMPLEEQ_RT_SAFETY_CHECKS
+	struct ScopedRealtimeSection {
+		explicit ScopedRealtimeSection(bool isRealtime = true) noexcept;
+		~ScopedRealtimeSection() noexcept;
+		
+	private:
+		bool active;
+		
+		JUCE_DECLARE_NON_COPYABLE(ScopedRealtimeSection)
+	};
+   #else
+	struct ScopedRealtimeSection {
+		explicit ScopedRealtimeSection(bool = true) noexcept { }
+	};
+   #endif
+}
@@ -0,0 +1,318 @@
+/*
+  ==============================================================================
+
+    VectorisedChain.h
+    The whole filter chain for several channels at once, one channel per SIMD lane.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+
+#include <vector>
+
+/* every channel of the eq usually uses the same coefficients, so instead of running one chain per channel
+ * the channels are interleaved into SIMD registers and go through the cascade together.
+ * that's up to 4 float channels per pass with SSE/NEON, 8 with AVX, so stereo and M/S come for free.
+ * doubles fit half as many lanes, but keep the low cut sections stable and quiet at high sample rates.
+ * lanes can also be given coefficients of their own, see setLaneCoefficients(). */
+template<typename SampleType>
+struct VectorisedChain {
+	using Vec = juce::dsp::SIMDRegister<SampleType>;
+	
+	static constexpr int numLanes = (int) Vec::SIMDNumElements;
+	
+	void prepare(int maximumBlockSize) {
+		interleaved.assign((size_t) maximumBlockSize, Vec::expand(0));
+		reset();
+	}
+	
+	void reset() {
+		lowCut.reset();
+		peak.reset();
+		highCut.reset();
+	}
+	
+	/** sets every lane at once, pass nullptr for a bypassed band */
+	void setCoefficients(const CutCoefficients *lowCutCoefficients, const BiquadCoefficients *peakCoefficients, const CutCoefficients *highCutCoefficients) {
+		lowCut.setCoefficients(lowCutCoefficients);
+		peak.setCoefficients(peakCoefficients);
+		highCut.setCoefficients(highCutCoefficients);
+	}
+	
+	/** sets a single lane, pass nullptr for a band the lane bypasses.
+	 * lanes needing fewer sections than others run the extra ones as pass-throughs */
+	void setLaneCoefficients(int lane, const CutCoefficients *lowCutCoefficients, const BiquadCoefficients *peakCoefficients, const CutCoefficients *highCutCoefficients) {
+		jassert(juce::isPositiveAndBelow(lane, numLanes));
+		
+		lowCut.setLaneCoefficients((size_t) lane, lowCutCoefficients);
+		peak.setLaneCoefficients((size_t) lane, peakCoefficients);
+		highCut.setLaneCoefficients((size_t) lane, highCutCoefficients);
+	}
+	
+	/** processes the first numLanes channels of the block in place */
+	void process(const juce::dsp::AudioBlock<SampleType> &block) noexcept {
+		jassert(! interleaved.empty());
+		
+		const auto numChannels = juce::jmin((int) block.getNumChannels(), numLanes);
+		const auto numSamples = block.getNumSamples();
+		
+		// hosts may send more samples than they promised in prepareToPlay
+		for (size_t start = 0; start < numSamples; start += interleaved.size()) {
+			const auto numToProcess = juce::jmin(interleaved.size(), numSamples - start);
+			auto subBlock = block.getSubBlock(start, numToProcess);
+			
+			interleave(subBlock, numChannels);
+			
+			lowCut.process(interleaved.data(), numToProcess);
+			peak.process(interleaved.data(), numToProcess);
+			highCut.process(interleaved.data(), numToProcess);
+			
+			deinterleave(subBlock, numChannels);
+		}
+	}
+	
+private:
+	/* a cascade of transposed direct form II biquads, the same structure juce::dsp::IIR::Filter uses.
+	 * the coefficients and state of all sections are stored inline, one flat array each.
+	 * the number of sections is a template parameter of the kernel, so every slope gets its own fully unrolled loop
+	 * with the state in registers, and the only branch left is picking the kernel once per block. */
+	template<int MaxNumSections>
+	struct Cascade {
+		// sections dropped by a shallower slope keep their state, like a bypassed juce::dsp::IIR::Filter would
+		void setCoefficients(const CutCoefficients *coefficients) {
+			const auto count = coefficients != nullptr ? coefficients->numSections : 0;
+			
+			for (int i = 0; i < count; ++i)
+				setSection((size_t) i, coefficients->sections[(size_t) i]);
+			
+			laneNumSections.fill(count);
+			numSections = count;
+		}
+		
+		void setCoefficients(const BiquadCoefficients *coefficients) {
+			if (coefficients != nullptr)
+				setSection(0, *coefficients);
+			
+			laneNumSections.fill(coefficients != nullptr ? 1 : 0);
+			numSections = laneNumSections[0];
+		}
+		
+		void setLaneCoefficients(size_t lane, const CutCoefficients *coefficients) {
+			laneNumSections[lane] = coefficients != nullptr ? coefficients->numSections : 0;
+			
+			for (int i = 0; i < MaxNumSections; ++i)
+				setLaneSection(lane, (size_t) i, i < laneNumSections[lane] ? coefficients->sections[(size_t) i] : BiquadCoefficients());
+			
+			updateNumSections();
+		}
+		
+		void setLaneCoefficients(size_t lane, const BiquadCoefficients *coefficients) {
+			laneNumSections[lane] = coefficients != nullptr ? 1 : 0;
+			setLaneSection(lane, 0, coefficients != nullptr ? *coefficients : BiquadCoefficients());
+			
+			updateNumSections();
+		}
+		
+		void reset() {
+			for (int i = 0; i < MaxNumSections; ++i)
+				s1[(size_t) i] = s2[(size_t) i] = Vec::expand(0);
+		}
+		
+		void process(Vec *samples, size_t numSamples) noexcept {
+			static_assert(MaxNumSections <= 4, "add the missing cases below");
+			
+			switch (numSections) {
+				case 1: processSections<1>(samples, numSamples); break;
+				case 2: if constexpr (MaxNumSections >= 2) processSections<2>(samples, numSamples); break;
+				case 3: if constexpr (MaxNumSections >= 3) processSections<3>(samples, numSamples); break;
+				case 4: if constexpr (MaxNumSections >= 4) processSections<4>(samples, numSamples); break;
+				default: break; // bypassed
+			}
+		}
+		
+	private:
+		std::array<Vec, MaxNumSections> b0, b1, b2, a1, a2;
+		std::array<Vec, MaxNumSections> s1, s2;
+		
+		// the lanes share one kernel, it runs as many sections as the lane that needs the most
+		std::array<int, numLanes> laneNumSections {};
+		int numSections = 0;
+		
+		void setSection(size_t index, const BiquadCoefficients &section) {
+			b0[index] = Vec::expand((SampleType) section.b0);
+			b1[index] = Vec::expand((SampleType) section.b1);
+			b2[index] = Vec::expand((SampleType) section.b2);
+			a1[index] = Vec::expand((SampleType) section.a1);
+			a2[index] = Vec::expand((SampleType) section.a2);
+		}
+		
+		void setLaneSection(size_t lane, size_t index, const BiquadCoefficients &section) {
+			b0[index].set(lane, (SampleType) section.b0);
+			b1[index].set(lane, (SampleType) section.b1);
+			b2[index].set(lane, (SampleType) section.b2);
+			a1[index].set(lane, (SampleType) section.a1);
+			a2[index].set(lane, (SampleType) section.a2);
+		}
+		
+		void updateNumSections() {
+			numSections = *std::max_element(laneNumSections.begin(), laneNumSections.end());
+		}
+		
+		template<int NumSections>
+		void processSections(Vec *samples, size_t numSamples) noexcept {
+			std::array<Vec, NumSections> z1, z2;
+			
+			for (int k = 0; k < NumSections; ++k) {
+				z1[(size_t) k] = s1[(size_t) k];
+				z2[(size_t) k] = s2[(size_t) k];
+			}
+			
+			for (size_t i = 0; i < numSamples; ++i) {
+				auto x = samples[i];
+				
+				// constant trip count, the compiler unrolls this completely
+				for (int k = 0; k < NumSections; ++k) {
+					const auto y = b0[(size_t) k] * x + z1[(size_t) k];
+					
+					z1[(size_t) k] = b1[(size_t) k] * x - a1[(size_t) k] * y + z2[(size_t) k];
+					z2[(size_t) k] = b2[(size_t) k] * x - a2[(size_t) k] * y;
+					
+					x = y;
+				}
+				
+				samples[i] = x;
+			}
+			
+			for (int k = 0; k < NumSections; ++k) {
+				s1[(size_t) k] = z1[(size_t) k];
+				s2[(size_t) k] = z2[(size_t) k];
+			}
+		}
+	};
+	
+	Cascade<CutCoefficients::maxNumSections> lowCut, highCut;
+	Cascade<1> peak;
+	
+	std::vector<Vec> interleaved;
+	
+	void interleave(const juce::dsp::AudioBlock<SampleType> &block, int numChannels) noexcept {
+		auto *lanes = reinterpret_cast<SampleType*>(interleaved.data());
+		const auto numSamples = block.getNumSamples();
+		
+		for (int channel = 0; channel < numLanes; ++channel) {
+			// unused lanes are fed silence so they can't carry anything stale around
+			if (channel < numChannels) {
+				const auto *source = block.getChannelPointer((size_t) channel);
+				
+				for (size_t i = 0; i < numSamples; ++i)
+					lanes[i * numLanes + (size_t) channel] = source[i];
+			} else {
+				for (size_t i = 0; i < numSamples; ++i)
+					lanes[i * numLanes + (size_t) channel] = 0;
+			}
+		}
+	}
+	
+	void deinterleave(const juce::dsp::AudioBlock<SampleType> &block, int numChannels) noexcept {
+		const auto *lanes = reinterpret_cast<const SampleType*>(interleaved.data());
+		const auto numSamples = block.getNumSamples();
+		
+		for (int channel = 0; channel < numChannels; ++channel) {
+			auto *destination = block.getChannelPointer((size_t) channel);
+			
+			for (size_t i = 0; i < numSamples; ++i)
+				destination[i] = lanes[i * numLanes + (size_t) channel];
+		}
+	}
+};
+
+/* one VectorisedChain per group of numLanes channels, sized from the bus layout in prepareToPlay.
+ * mono, stereo, 5.1, 7.1.4 and ambisonic stems all run through the same code,
+ * and since each group fills a whole register, the cost grows by group rather than by channel.
+ * channels are linked by default, setChannelCoefficients() unlinks a single one until linkChannel(). */
+template<typename SampleType>
+struct ChannelChainPool {
+	using Chain = VectorisedChain<SampleType>;
+	
+	/** links every channel again */
+	void prepare(int numChannelsToUse, int maximumBlockSize) {
+		numChannels = numChannelsToUse;
+		groups.resize((size_t) ((numChannels + Chain::numLanes - 1) / Chain::numLanes));
+		linked.assign((size_t) numChannels, true);
+		
+		for (auto &group : groups)
+			group.prepare(maximumBlockSize);
+	}
+	
+	void reset() {
+		for (auto &group : groups)
+			group.reset();
+	}
+	
+	int getNumChannels() const { return numChannels; }
+	
+	/** the linked case, every linked channel gets the same coefficients and the unlinked ones keep their own */
+	void setCoefficients(const CutCoefficients *lowCut, const BiquadCoefficients *peak, const CutCoefficients *highCut) {
+		for (int group = 0; group < (int) groups.size(); ++group) {
+			auto &chain = groups[(size_t) group];
+			
+			// groups without an unlinked channel set the whole register at once
+			if (isGroupLinked(group)) {
+				chain.setCoefficients(lowCut, peak, highCut);
+				continue;
+			}
+			
+			for (int lane = 0; lane < Chain::numLanes; ++lane)
+				if (isChannelLinked(group * Chain::numLanes + lane))
+					chain.setLaneCoefficients(lane, lowCut, peak, highCut);
+		}
+	}
+	
+	/** unlinks one channel and gives it coefficients of its own, e.g. to leave an LFE channel unfiltered.
+	 * setCoefficients() leaves it alone from then on */
+	void setChannelCoefficients(int channel, const CutCoefficients *lowCut, const BiquadCoefficients *peak, const CutCoefficients *highCut) {
+		jassert(juce::isPositiveAndBelow(channel, numChannels));
+		
+		linked[(size_t) channel] = false;
+		groups[(size_t) (channel / Chain::numLanes)].setLaneCoefficients(channel % Chain::numLanes, lowCut, peak, highCut);
+	}
+	
+	/** the channel follows setCoefficients() again, starting with the next call */
+	void linkChannel(int channel) {
+		jassert(juce::isPositiveAndBelow(channel, numChannels));
+		
+		linked[(size_t) channel] = true;
+	}
+	
+	/** the lanes past the last channel count as linked, they only ever see silence */
+	bool isChannelLinked(int channel) const {
+		return channel >= numChannels || linked[(size_t) channel];
+	}
+	
+	void process(const juce::dsp::AudioBlock<SampleType> &block) noexcept {
+		const auto channelsToProcess = juce::jmin(numChannels, (int) block.getNumChannels());
+		
+		for (int first = 0, group = 0; first < channelsToProcess; first += Chain::numLanes, ++group) {
+			const auto numInGroup = juce::jmin(Chain::numLanes, channelsToProcess - first);
+			groups[(size_t) group].process(block.getSubsetChannelBlock((size_t) first, (size_t) numInGroup));
+		}
+	}
+	
+private:
+	int numChannels = 0;
+	std::vector<Chain> groups;
+	std::vector<bool> linked;
+	
+	bool isGroupLinked(int group) const {
+		for (int lane = 0; lane < Chain::numLanes; ++lane)
+			if (! isChannelLinked(group * Chain::numLanes + lane))
+				return false;
+		
+		return true;
+	}
+};